@@ -405,6 +405,7 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/action_target_generator.cc',
         'tools/gn/action_values.cc',
         'tools/gn/analyzer.cc',
+        'tools/gn/arena.cc',
         'tools/gn/args.cc',
         'tools/gn/binary_target_generator.cc',
         'tools/gn/builder.cc',
@@ -414,6 +415,7 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/bundle_data_target_generator.cc',
         'tools/gn/bundle_file_rule.cc',
         'tools/gn/c_include_iterator.cc',
+        'tools/gn/cache_file.cc',
         'tools/gn/command_analyze.cc',
         'tools/gn/command_args.cc',
         'tools/gn/command_check.cc',
@@ -426,6 +428,7 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/command_ls.cc',
         'tools/gn/command_path.cc',
         'tools/gn/command_refs.cc',
+        'tools/gn/command_server.cc',
         'tools/gn/commands.cc',
         'tools/gn/compile_commands_writer.cc',
         'tools/gn/config.cc',
@@ -440,6 +443,7 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/err.cc',
         'tools/gn/escape.cc',
         'tools/gn/exec_process.cc',
+        'tools/gn/exec_script_cache.cc',
         'tools/gn/filesystem_utils.cc',
         'tools/gn/function_exec_script.cc',
         'tools/gn/function_foreach.cc',
@@ -463,6 +467,7 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/group_target_generator.cc',
         'tools/gn/header_checker.cc',
         'tools/gn/import_manager.cc',
+        'tools/gn/include_scan_cache.cc',
         'tools/gn/inherited_libraries.cc',
         'tools/gn/input_conversion.cc',
         'tools/gn/input_file.cc',
@@ -485,6 +490,7 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/ninja_generated_file_target_writer.cc',
         'tools/gn/ninja_group_target_writer.cc',
         'tools/gn/ninja_target_command_util.cc',
+        'tools/gn/ninja_target_cache.cc',
         'tools/gn/ninja_target_writer.cc',
         'tools/gn/ninja_toolchain_writer.cc',
         'tools/gn/ninja_utils.cc',
@@ -492,6 +498,7 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/operators.cc',
         'tools/gn/output_conversion.cc',
         'tools/gn/output_file.cc',
+        'tools/gn/parse_cache.cc',
         'tools/gn/parse_node_value_adapter.cc',
         'tools/gn/parser.cc',
         'tools/gn/parse_tree.cc',
@@ -509,6 +516,8 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/source_file.cc',
         'tools/gn/source_file_type.cc',
         'tools/gn/standard_out.cc',
+        'tools/gn/string_atom.cc',
+        'tools/gn/string_output_buffer.cc',
         'tools/gn/string_utils.cc',
         'tools/gn/substitution_list.cc',
         'tools/gn/substitution_pattern.cc',
@@ -548,15 +557,18 @@ def WriteGNNinja(path, platform, host, options):
       'gn_unittests': { 'sources': [
         'tools/gn/action_target_generator_unittest.cc',
         'tools/gn/analyzer_unittest.cc',
+        'tools/gn/arena_unittest.cc',
         'tools/gn/args_unittest.cc',
         'tools/gn/builder_unittest.cc',
         'tools/gn/c_include_iterator_unittest.cc',
         'tools/gn/command_format_unittest.cc',
+        'tools/gn/command_server_unittest.cc',
         'tools/gn/compile_commands_writer_unittest.cc',
         'tools/gn/config_unittest.cc',
         'tools/gn/config_values_extractors_unittest.cc',
         'tools/gn/escape_unittest.cc',
         'tools/gn/exec_process_unittest.cc',
+        'tools/gn/exec_script_cache_unittest.cc',
         'tools/gn/filesystem_utils_unittest.cc',
         'tools/gn/function_foreach_unittest.cc',
         'tools/gn/function_forward_variables_from_unittest.cc',
@@ -571,6 +583,7 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/functions_target_unittest.cc',
         'tools/gn/functions_unittest.cc',
         'tools/gn/header_checker_unittest.cc',
+        'tools/gn/include_scan_cache_unittest.cc',
         'tools/gn/inherited_libraries_unittest.cc',
         'tools/gn/input_conversion_unittest.cc',
         'tools/gn/label_pattern_unittest.cc',
@@ -586,10 +599,13 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/ninja_create_bundle_target_writer_unittest.cc',
         'tools/gn/ninja_generated_file_target_writer_unittest.cc',
         'tools/gn/ninja_group_target_writer_unittest.cc',
+        'tools/gn/ninja_target_cache_unittest.cc',
         'tools/gn/ninja_target_writer_unittest.cc',
         'tools/gn/ninja_toolchain_writer_unittest.cc',
+        'tools/gn/ninja_writer_unittest.cc',
         'tools/gn/operators_unittest.cc',
         'tools/gn/output_conversion_unittest.cc',
+        'tools/gn/parse_cache_unittest.cc',
         'tools/gn/parse_tree_unittest.cc',
         'tools/gn/parser_unittest.cc',
         'tools/gn/path_output_unittest.cc',
@@ -598,8 +614,11 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/scope_per_file_provider_unittest.cc',
         'tools/gn/scope_unittest.cc',
         'tools/gn/setup_unittest.cc',
+        'tools/gn/small_map_unittest.cc',
         'tools/gn/source_dir_unittest.cc',
         'tools/gn/source_file_unittest.cc',
+        'tools/gn/string_atom_unittest.cc',
+        'tools/gn/string_output_buffer_unittest.cc',
         'tools/gn/string_utils_unittest.cc',
         'tools/gn/substitution_pattern_unittest.cc',
         'tools/gn/substitution_writer_unittest.cc',
@@ -608,6 +627,7 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/test_with_scheduler.cc',
         'tools/gn/test_with_scope.cc',
         'tools/gn/tokenizer_unittest.cc',
+        'tools/gn/trace_unittest.cc',
         'tools/gn/unique_vector_unittest.cc',
         'tools/gn/value_unittest.cc',
         'tools/gn/visibility_unittest.cc',
@@ -616,6 +636,7 @@ def WriteGNNinja(path, platform, host, options):
         'tools/gn/xcode_object_unittest.cc',
         'tools/gn/xml_element_writer_unittest.cc',
         'util/test/gn_test.cc',
+        'util/worker_pool_unittest.cc',
       ], 'tool': 'cxx', 'include_dirs': [], 'libs': []},
   }
 
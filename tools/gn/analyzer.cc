@@ -8,11 +8,12 @@
 #include <iterator>
 #include <memory>
 #include <set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
-#include "base/strings/string_util.h"
 #include "base/values.h"
 #include "tools/gn/builder.h"
 #include "tools/gn/config.h"
@@ -224,37 +225,62 @@ Analyzer::Analyzer(const Builder& builder,
       build_config_file_(build_config_file),
       dot_file_(dot_file),
       build_args_dependency_files_(build_args_dependency_files) {
-  for (const auto* item : all_items_) {
-    labels_to_items_[item->label()] = item;
+  std::unordered_map<const Item*, size_t> item_indices;
+  for (size_t i = 0; i < all_items_.size(); i++) {
+    labels_to_items_[all_items_[i]->label()] = all_items_[i];
+    item_indices[all_items_[i]] = i;
+    IndexFilesOfItem(i);
+  }
 
-    // Fill dep_map_.
+  // Collect the (dependency, dependent) pairs. Dependencies that aren't in
+  // |all_items_| can't be affected by anything, so they are skipped.
+  std::vector<std::pair<size_t, size_t>> edges;
+  auto add_edge = [&item_indices, &edges](const Item* dep, size_t dependent) {
+    auto found = item_indices.find(dep);
+    if (found != item_indices.end())
+      edges.emplace_back(found->second, dependent);
+  };
+  for (size_t i = 0; i < all_items_.size(); i++) {
+    const Item* item = all_items_[i];
     if (item->AsTarget()) {
       for (const auto& dep_target_pair :
            item->AsTarget()->GetDeps(Target::DEPS_ALL))
-        dep_map_.insert(std::make_pair(dep_target_pair.ptr, item));
+        add_edge(dep_target_pair.ptr, i);
 
       for (const auto& dep_config_pair : item->AsTarget()->configs())
-        dep_map_.insert(std::make_pair(dep_config_pair.ptr, item));
+        add_edge(dep_config_pair.ptr, i);
 
-      dep_map_.insert(std::make_pair(item->AsTarget()->toolchain(), item));
+      add_edge(item->AsTarget()->toolchain(), i);
 
       if (item->AsTarget()->output_type() == Target::ACTION ||
           item->AsTarget()->output_type() == Target::ACTION_FOREACH) {
         const LabelPtrPair<Pool>& pool =
             item->AsTarget()->action_values().pool();
         if (pool.ptr)
-          dep_map_.insert(std::make_pair(pool.ptr, item));
+          add_edge(pool.ptr, i);
       }
     } else if (item->AsConfig()) {
       for (const auto& dep_config_pair : item->AsConfig()->configs())
-        dep_map_.insert(std::make_pair(dep_config_pair.ptr, item));
+        add_edge(dep_config_pair.ptr, i);
     } else if (item->AsToolchain()) {
       for (const auto& dep_pair : item->AsToolchain()->deps())
-        dep_map_.insert(std::make_pair(dep_pair.ptr, item));
+        add_edge(dep_pair.ptr, i);
     } else {
       DCHECK(item->AsPool());
     }
   }
+
+  // Bucket them by dependency.
+  dependent_offsets_.assign(all_items_.size() + 1, 0);
+  for (const auto& edge : edges)
+    dependent_offsets_[edge.first + 1]++;
+  for (size_t i = 0; i < all_items_.size(); i++)
+    dependent_offsets_[i + 1] += dependent_offsets_[i];
+  dependents_.resize(edges.size());
+  std::vector<size_t> next(dependent_offsets_.begin(),
+                           dependent_offsets_.end() - 1);
+  for (const auto& edge : edges)
+    dependents_[next[edge.first]++] = edge.second;
 }
 
 Analyzer::~Analyzer() = default;
@@ -312,9 +338,10 @@ std::string Analyzer::Analyze(const std::string& input, Err* err) const {
   }
 
   std::set<const Target*> root_targets;
-  for (const auto* item : all_items_) {
-    if (item->AsTarget() && dep_map_.find(item) == dep_map_.end())
-      root_targets.insert(item->AsTarget());
+  for (size_t i = 0; i < all_items_.size(); i++) {
+    if (all_items_[i]->AsTarget() &&
+        dependent_offsets_[i] == dependent_offsets_[i + 1])
+      root_targets.insert(all_items_[i]->AsTarget());
   }
 
   std::set<const Target*> compile_targets = TargetsFor(inputs.compile_labels);
@@ -344,14 +371,26 @@ std::string Analyzer::Analyze(const std::string& input, Err* err) const {
 
 std::set<const Item*> Analyzer::GetAllAffectedItems(
     const std::set<const SourceFile*>& source_files) const {
-  std::set<const Item*> directly_affected_items;
+  // Walk the reverse dependencies breadth-first from all the items referring
+  // to the files at once.
+  std::vector<size_t> queue;
   for (auto* source_file : source_files)
-    AddItemsDirectlyReferringToFile(source_file, &directly_affected_items);
+    AddItemsDirectlyReferringToFile(source_file, &queue);
 
+  std::vector<bool> affected(all_items_.size(), false);
   std::set<const Item*> all_affected_items;
-  for (auto* affected_item : directly_affected_items)
-    AddAllItemsReferringToItem(affected_item, &all_affected_items);
-
+  for (size_t i = 0; i < queue.size(); i++) {
+    size_t item = queue[i];
+    if (affected[item])
+      continue;
+    affected[item] = true;
+    all_affected_items.insert(all_items_[item]);
+    for (size_t j = dependent_offsets_[item]; j < dependent_offsets_[item + 1];
+         j++) {
+      if (!affected[dependents_[j]])
+        queue.push_back(dependents_[j]);
+    }
+  }
   return all_affected_items;
 }
 
@@ -400,74 +439,56 @@ void Analyzer::FilterTarget(const Target* target,
   }
 }
 
-bool Analyzer::ItemRefersToFile(const Item* item,
-                                const SourceFile* file) const {
-  for (const auto& cur_file : item->build_dependency_files()) {
-    if (cur_file == *file)
-      return true;
-  }
-
-  if (!item->AsTarget())
-    return false;
+void Analyzer::IndexFilesOfItem(size_t item_index) {
+  const Item* item = all_items_[item_index];
+  for (const auto& cur_file : item->build_dependency_files())
+    file_to_items_[cur_file].push_back(item_index);
 
   const Target* target = item->AsTarget();
-  for (const auto& cur_file : target->sources()) {
-    if (cur_file == *file)
-      return true;
-  }
-  for (const auto& cur_file : target->public_headers()) {
-    if (cur_file == *file)
-      return true;
-  }
+  if (!target)
+    return;
+
+  for (const auto& cur_file : target->sources())
+    file_to_items_[cur_file].push_back(item_index);
+  for (const auto& cur_file : target->public_headers())
+    file_to_items_[cur_file].push_back(item_index);
   for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
-    for (const auto& cur_file : iter.cur().inputs()) {
-      if (cur_file == *file)
-        return true;
-    }
-  }
-  for (const auto& cur_file : target->data()) {
-    if (cur_file == file->value())
-      return true;
-    if (cur_file.back() == '/' &&
-        base::StartsWith(file->value(), cur_file, base::CompareCase::SENSITIVE))
-      return true;
+    for (const auto& cur_file : iter.cur().inputs())
+      file_to_items_[cur_file].push_back(item_index);
   }
+  for (const auto& cur_file : target->data())
+    data_to_items_[cur_file].push_back(item_index);
 
-  if (target->action_values().script().value() == file->value())
-    return true;
+  const SourceFile& script = target->action_values().script();
+  if (!script.is_null())
+    file_to_items_[script].push_back(item_index);
 
   std::vector<SourceFile> outputs;
   target->action_values().GetOutputsAsSourceFiles(target, &outputs);
-  for (const auto& cur_file : outputs) {
-    if (cur_file == *file)
-      return true;
-  }
-  return false;
+  for (const auto& cur_file : outputs)
+    file_to_items_[cur_file].push_back(item_index);
 }
 
 void Analyzer::AddItemsDirectlyReferringToFile(
     const SourceFile* file,
-    std::set<const Item*>* directly_affected_items) const {
-  for (const auto* item : all_items_) {
-    if (ItemRefersToFile(item, file))
-      directly_affected_items->insert(item);
+    std::vector<size_t>* indices) const {
+  auto found = file_to_items_.find(*file);
+  if (found != file_to_items_.end())
+    indices->insert(indices->end(), found->second.begin(), found->second.end());
+
+  // Data can name the file itself, or any directory containing it.
+  const std::string& value = file->value();
+  for (size_t i = 0; i < value.size(); i++) {
+    if (value[i] != '/' && i != value.size() - 1)
+      continue;
+    auto data_found = data_to_items_.find(value.substr(0, i + 1));
+    if (data_found != data_to_items_.end()) {
+      indices->insert(indices->end(), data_found->second.begin(),
+                      data_found->second.end());
+    }
   }
 }
 
-void Analyzer::AddAllItemsReferringToItem(
-    const Item* item,
-    std::set<const Item*>* all_affected_items) const {
-  if (all_affected_items->find(item) != all_affected_items->end())
-    return;  // Already found this item.
-
-  all_affected_items->insert(item);
-
-  auto dep_begin = dep_map_.lower_bound(item);
-  auto dep_end = dep_map_.upper_bound(item);
-  for (auto cur_dep = dep_begin; cur_dep != dep_end; ++cur_dep)
-    AddAllItemsReferringToItem(cur_dep->second, all_affected_items);
-}
-
 bool Analyzer::WereMainGNFilesModified(
     const std::set<const SourceFile*>& modified_files) const {
   for (const auto* file : modified_files) {
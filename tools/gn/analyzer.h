@@ -5,8 +5,12 @@
 #ifndef TOOLS_GN_ANALYZER_H_
 #define TOOLS_GN_ANALYZER_H_
 
+#include <stddef.h>
+
+#include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "tools/gn/builder.h"
@@ -74,14 +78,13 @@ class Analyzer {
                     std::set<const Target*>* seen,
                     std::set<const Target*>* filtered) const;
 
-  bool ItemRefersToFile(const Item* item, const SourceFile* file) const;
-
-  void AddItemsDirectlyReferringToFile(
-      const SourceFile* file,
-      std::set<const Item*>* affected_items) const;
+  // Adds the given item to file_to_items_ and data_to_items_ under all the
+  // files it refers to.
+  void IndexFilesOfItem(size_t item_index);
 
-  void AddAllItemsReferringToItem(const Item* item,
-                                  std::set<const Item*>* affected_items) const;
+  // Adds the indices of the items referring to the given file to |indices|.
+  void AddItemsDirectlyReferringToFile(const SourceFile* file,
+                                       std::vector<size_t>* indices) const;
 
   // Main GN files stand for files whose context are used globally to execute
   // every other build files, this list includes dot file, build config file,
@@ -93,8 +96,19 @@ class Analyzer {
   std::map<Label, const Item*> labels_to_items_;
   Label default_toolchain_;
 
-  // Maps items to the list of items that depend on them.
-  std::multimap<const Item*, const Item*> dep_map_;
+  // The items that depend on all_items_[i] are all_items_[j] for each j in
+  // dependents_[dependent_offsets_[i] .. dependent_offsets_[i + 1]). Storing
+  // the reverse dependencies in one flat array makes walking them cheap.
+  std::vector<size_t> dependent_offsets_;
+  std::vector<size_t> dependents_;
+
+  // Maps each file (sources, public headers, inputs, build files, scripts and
+  // outputs) to the indices of the items referring to it.
+  std::unordered_map<SourceFile, std::vector<size_t>> file_to_items_;
+
+  // Same for the "data" of targets, which may also be directories ending in a
+  // slash that refer to every file inside them.
+  std::unordered_map<std::string, std::vector<size_t>> data_to_items_;
 
   const SourceFile build_config_file_;
   const SourceFile dot_file_;
@@ -3,8 +3,16 @@
 // found in the LICENSE file.
 
 #include "tools/gn/analyzer.h"
+
+#include <stdio.h>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_file.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_split.h"
 #include "tools/gn/build_settings.h"
 #include "tools/gn/builder.h"
+#include "tools/gn/commands.h"
 #include "tools/gn/config.h"
 #include "tools/gn/loader.h"
 #include "tools/gn/pool.h"
@@ -248,6 +256,39 @@ TEST_F(AnalyzerTest, TargetRefersToData) {
       "}");
 }
 
+// Tests that a target is marked as affected if a file inside one of its data
+// directories is modified.
+TEST_F(AnalyzerTest, TargetRefersToDataDirectory) {
+  Target* t = MakeTarget("//dir", "target_name");
+  t->data().push_back("//dir/data/");
+  builder_.ItemDefined(std::unique_ptr<Item>(t));
+
+  // A file whose name only starts with the directory name isn't inside it.
+  RunAnalyzerTest(
+      R"({
+       "files": [ "//dir/database.txt" ],
+       "additional_compile_targets": [ "all" ],
+       "test_targets": [ "//dir:target_name" ]
+       })",
+      "{"
+      R"("compile_targets":[],)"
+      R"/("status":"No dependency",)/"
+      R"("test_targets":[])"
+      "}");
+
+  RunAnalyzerTest(
+      R"({
+       "files": [ "//dir/database.txt", "//dir/data/sub/file.txt" ],
+       "additional_compile_targets": [ "all" ],
+       "test_targets": [ "//dir:target_name" ]
+       })",
+      "{"
+      R"("compile_targets":["all"],)"
+      R"/("status":"Found dependency",)/"
+      R"("test_targets":["//dir:target_name"])"
+      "}");
+}
+
 // Tests that a target is marked as affected if the target is an action and its
 // action script is modified.
 TEST_F(AnalyzerTest, TargetRefersToActionScript) {
@@ -596,4 +637,62 @@ TEST_F(AnalyzerTest, BuildArgsDependencyFileWasModified) {
       "}");
 }
 
+// Answers every line of a batch against the same graph, including the ones
+// that can't be parsed.
+TEST_F(AnalyzerTest, Batch) {
+  Target* t = MakeTarget("//dir", "target_name");
+  t->sources().push_back(SourceFile("//dir/file_name.cc"));
+  builder_.ItemDefined(std::unique_ptr<Item>(t));
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath input_path = temp_dir.GetPath().AppendASCII("input.json");
+  base::FilePath output_path = temp_dir.GetPath().AppendASCII("output.json");
+  std::string input =
+      R"({"files": ["//dir/file_name.cc"], )"
+      R"("additional_compile_targets": [], )"
+      R"("test_targets": ["//dir:target_name"]})"
+      "\n"
+      "\n"
+      "{not json\n"
+      R"({"files": ["//dir/other.cc"], )"
+      R"("additional_compile_targets": [], )"
+      R"("test_targets": ["//dir:target_name"]})"
+      "\r\n";
+  ASSERT_EQ(static_cast<int>(input.size()),
+            base::WriteFile(input_path, input.data(),
+                            static_cast<int>(input.size())));
+
+  Analyzer analyzer(builder_, SourceFile("//build/config/BUILDCONFIG.gn"),
+                    SourceFile("//.gn"), {});
+  {
+    base::ScopedFILE input_file(base::OpenFile(input_path, "rb"));
+    base::ScopedFILE output_file(base::OpenFile(output_path, "wb"));
+    ASSERT_TRUE(input_file && output_file);
+    EXPECT_EQ(0, commands::AnalyzeBatch(analyzer, input_file.get(),
+                                        output_file.get(), "output.json"));
+  }
+
+  std::string output;
+  ASSERT_TRUE(base::ReadFileToString(output_path, &output));
+  std::vector<std::string> lines = base::SplitString(
+      output, "\n", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  ASSERT_EQ(3u, lines.size());
+  EXPECT_EQ(
+      "{"
+      R"("compile_targets":[],)"
+      R"/("status":"Found dependency",)/"
+      R"("test_targets":["//dir:target_name"])"
+      "}",
+      lines[0]);
+  EXPECT_NE(std::string::npos, lines[1].find(R"("error":)")) << lines[1];
+  EXPECT_EQ(
+      "{"
+      R"("compile_targets":[],)"
+      R"/("status":"No dependency",)/"
+      R"("test_targets":[])"
+      "}",
+      lines[2]);
+}
+
 }  // namespace gn_analyzer_unittest
@@ -0,0 +1,58 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/arena.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+
+#include "base/logging.h"
+
+namespace {
+
+const size_t kMinBlockSize = 4 * 1024;
+const size_t kMaxBlockSize = 256 * 1024;
+
+}  // namespace
+
+Arena::Arena(size_t first_block_size)
+    : next_(nullptr),
+      end_(nullptr),
+      next_block_size_(std::max(first_block_size, kMinBlockSize)),
+      bytes_reserved_(0) {}
+
+Arena::~Arena() = default;
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  DCHECK(alignment && (alignment & (alignment - 1)) == 0);
+  DCHECK(alignment <= alignof(std::max_align_t));
+
+  uintptr_t next = reinterpret_cast<uintptr_t>(next_);
+  size_t padding = (alignment - (next & (alignment - 1))) & (alignment - 1);
+  if (!next_ || static_cast<size_t>(end_ - next_) < padding + size) {
+    // New blocks are maximally aligned, so no padding is needed.
+    AddBlock(size);
+    padding = 0;
+  }
+
+  char* result = next_ + padding;
+  next_ = result + size;
+  return result;
+}
+
+void Arena::AddBlock(size_t min_size) {
+  size_t block_size = std::max(next_block_size_, min_size);
+  if (blocks_.empty())
+    next_block_size_ = kMinBlockSize;
+  else
+    next_block_size_ = std::min(next_block_size_ * 2, kMaxBlockSize);
+
+  // Not std::make_unique, which would zero the block.
+  blocks_.push_back(std::unique_ptr<char[]>(new char[block_size]));
+  next_ = blocks_.back().get();
+  end_ = next_ + block_size;
+  bytes_reserved_ += block_size;
+}
@@ -0,0 +1,51 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_ARENA_H_
+#define TOOLS_GN_ARENA_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+
+// A bump-pointer allocator. Memory is handed out from a list of blocks and is
+// only released, all at once, when the arena is destroyed. Destructors of
+// objects placed in the arena are not run by the arena.
+//
+// This class is not threadsafe.
+class Arena {
+ public:
+  // The first block has the given size, which should be the expected total
+  // size when it's known. Later blocks start small and grow.
+  explicit Arena(size_t first_block_size);
+  ~Arena();
+
+  // Returns |size| bytes aligned to |alignment|, which must be a power of two
+  // no larger than alignof(std::max_align_t).
+  void* Allocate(size_t size, size_t alignment);
+
+  // Total size of the blocks owned by the arena.
+  size_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  // Starts a new block that can hold at least |min_size| bytes.
+  void AddBlock(size_t min_size);
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+
+  // Free space in the current block.
+  char* next_;
+  char* end_;
+
+  size_t next_block_size_;
+
+  size_t bytes_reserved_;
+
+  DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+#endif  // TOOLS_GN_ARENA_H_
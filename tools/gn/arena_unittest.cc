@@ -0,0 +1,60 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "tools/gn/arena.h"
+#include "tools/gn/input_file.h"
+#include "tools/gn/parse_tree.h"
+#include "tools/gn/parser.h"
+#include "tools/gn/tokenizer.h"
+#include "util/test/test.h"
+
+TEST(Arena, Allocate) {
+  Arena arena(0);
+  EXPECT_EQ(0u, arena.bytes_reserved());
+
+  char* a = static_cast<char*>(arena.Allocate(3, 1));
+  char* b = static_cast<char*>(arena.Allocate(8, 8));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(b) % 8);
+  EXPECT_LE(a + 3, b);
+  size_t reserved = arena.bytes_reserved();
+  EXPECT_LT(0u, reserved);
+
+  // Larger than any block, so it gets its own.
+  void* big = arena.Allocate(1024 * 1024, 16);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(big) % 16);
+  EXPECT_LE(reserved + 1024 * 1024, arena.bytes_reserved());
+}
+
+TEST(Arena, ParseNodes) {
+  InputFile input_file(SourceFile("//test"));
+  input_file.SetContents("a = [ 1, 2 ]\nif (a == b) { c = \"d\" }\n");
+
+  Err err;
+  std::vector<Token> tokens = Tokenizer::Tokenize(&input_file, &err);
+  ASSERT_FALSE(err.has_error());
+
+  Arena arena(1024);
+  std::unique_ptr<ParseNode> root;
+  {
+    ScopedParseNodeArena scoped_arena(&arena);
+    root = Parser::Parse(tokens, &err);
+  }
+  ASSERT_FALSE(err.has_error());
+  ASSERT_TRUE(root);
+  EXPECT_LT(0u, arena.bytes_reserved());
+  ASSERT_EQ(2u, root->AsBlock()->statements().size());
+
+  // Outside of the scope, nodes come from the heap again. Deleting either kind
+  // of node is fine.
+  size_t reserved = arena.bytes_reserved();
+  std::unique_ptr<ParseNode> heap_root = Parser::Parse(tokens, &err);
+  ASSERT_TRUE(heap_root);
+  EXPECT_EQ(reserved, arena.bytes_reserved());
+  heap_root.reset();
+  root.reset();
+}
@@ -20,7 +20,8 @@ BuildSettings::BuildSettings(const BuildSettings& other)
       build_config_file_(other.build_config_file_),
       arg_file_template_path_(other.arg_file_template_path_),
       build_dir_(other.build_dir_),
-      build_args_(other.build_args_) {}
+      build_args_(other.build_args_),
+      ninja_shard_count_(other.ninja_shard_count_) {}
 
 BuildSettings::~BuildSettings() = default;
 
@@ -124,6 +124,11 @@ class BuildSettings {
     exec_script_whitelist_ = std::move(list);
   }
 
+  // Number of files the rules of each toolchain.ninja and the phony rules of
+  // build.ninja are split into. 1 writes them all to the one file.
+  size_t ninja_shard_count() const { return ninja_shard_count_; }
+  void set_ninja_shard_count(size_t count) { ninja_shard_count_ = count; }
+
  private:
   base::FilePath dotfile_path_;
   std::string dotfile_path_utf8_;
@@ -138,6 +143,7 @@ class BuildSettings {
   SourceFile arg_file_template_path_;
   SourceDir build_dir_;
   Args build_args_;
+  size_t ninja_shard_count_ = 1;
 
   ItemDefinedCallback item_defined_callback_;
   PrintCallback print_callback_;
@@ -55,13 +55,15 @@ bool RecursiveFindCycle(const BuilderRecord* search_in,
 
 }  // namespace
 
-Builder::Builder(Loader* loader) : loader_(loader) {}
+Builder::Builder(Loader* loader)
+    : loader_(loader), resolve_on_worker_pool_(false) {}
 
 Builder::~Builder() = default;
 
 void Builder::ItemDefined(std::unique_ptr<Item> item) {
   ScopedTrace trace(TraceItem::TRACE_DEFINE_TARGET, item->label());
   trace.SetToolchain(item->settings()->toolchain_label());
+  trace.SetBuildFile(Loader::BuildFileForLabel(item->label()));
 
   BuilderRecord::ItemType type = BuilderRecord::TypeOfItem(item.get());
 
@@ -328,6 +330,7 @@ BuilderRecord* Builder::GetOrCreateRecordOfType(const Label& label,
     new_record->set_originally_referenced_from(request_from);
     record = new_record.get();
     records_[label] = std::move(new_record);
+    AddToTraceCounter(TRACE_COUNTER_PENDING_RECORDS, 1);
     return record;
   }
 
@@ -504,10 +507,45 @@ bool Builder::ResolveItem(BuilderRecord* record, Err* err) {
       return false;
   }
 
-  record->set_resolved(true);
+  if (resolve_on_worker_pool_ &&
+      record->type() == BuilderRecord::ITEM_TARGET) {
+    // Keep the scheduler running until the result is back on this thread.
+    g_scheduler->IncrementWorkCount();
+    g_scheduler->ScheduleWork(base::BindOnce(
+        &Builder::ResolveItemOnWorker, base::Unretained(this), record));
+    return true;
+  }
 
   if (!record->item()->OnResolved(err))
     return false;
+  return CompleteResolveItem(record, err);
+}
+
+void Builder::ResolveItemOnWorker(BuilderRecord* record) {
+  // Only the item is touched here. Its dependencies are all resolved and no
+  // longer change, and the record itself is only updated on the main thread.
+  Err err;
+  record->item()->OnResolved(&err);
+  g_scheduler->task_runner()->PostTask(
+      base::BindOnce(&Builder::OnItemResolvedOnWorker, base::Unretained(this),
+                     record, err));
+}
+
+void Builder::OnItemResolvedOnWorker(BuilderRecord* record, const Err& err) {
+  if (err.has_error()) {
+    g_scheduler->FailWithError(err);
+  } else {
+    Err complete_err;
+    if (!CompleteResolveItem(record, &complete_err))
+      g_scheduler->FailWithError(complete_err);
+  }
+  g_scheduler->DecrementWorkCount();
+}
+
+bool Builder::CompleteResolveItem(BuilderRecord* record, Err* err) {
+  record->set_resolved(true);
+  AddToTraceCounter(TRACE_COUNTER_PENDING_RECORDS, -1);
+
   if (record->should_generate() && !resolved_and_generated_callback_.is_null())
     resolved_and_generated_callback_.Run(record);
 
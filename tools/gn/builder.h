@@ -22,6 +22,11 @@ class ParseNode;
 
 // The builder assembles the dependency tree. It is not threadsafe and runs on
 // the main thread only. See also BuilderRecord.
+//
+// When resolving on the worker pool is enabled, the expensive part of
+// resolving a target (Target::OnResolved) runs on the scheduler's worker pool
+// once all of its dependencies are resolved. All BuilderRecord state changes
+// still happen on the main thread.
 class Builder {
  public:
   typedef base::Callback<void(const BuilderRecord*)> ResolvedGeneratedCallback;
@@ -38,6 +43,11 @@ class Builder {
 
   Loader* loader() const { return loader_; }
 
+  // Enables running Target::OnResolved on the scheduler's worker pool. This
+  // requires a running scheduler and is off by default.
+  bool resolve_on_worker_pool() const { return resolve_on_worker_pool_; }
+  void set_resolve_on_worker_pool(bool r) { resolve_on_worker_pool_ = r; }
+
   void ItemDefined(std::unique_ptr<Item> item);
 
   // Returns NULL if there is not a thing with the corresponding label.
@@ -120,6 +130,15 @@ class Builder {
   // target's Label*Vectors with the resolved pointers.
   bool ResolveItem(BuilderRecord* record, Err* err);
 
+  // Runs the item's OnResolved on a worker thread and posts the result back
+  // to OnItemResolvedOnWorker on the main thread.
+  void ResolveItemOnWorker(BuilderRecord* record);
+  void OnItemResolvedOnWorker(BuilderRecord* record, const Err& err);
+
+  // Marks an item whose OnResolved has run as resolved, and resolves
+  // everybody waiting on it.
+  bool CompleteResolveItem(BuilderRecord* record, Err* err);
+
   // Fills in the pointers in the given vector based on the labels. We assume
   // that everything should be resolved by this point, so will return an error
   // if anything isn't found or if the type doesn't match.
@@ -142,6 +161,8 @@ class Builder {
 
   ResolvedGeneratedCallback resolved_and_generated_callback_;
 
+  bool resolve_on_worker_pool_;
+
   DISALLOW_COPY_AND_ASSIGN(Builder);
 };
 
@@ -6,6 +6,7 @@
 #include "tools/gn/config.h"
 #include "tools/gn/loader.h"
 #include "tools/gn/target.h"
+#include "tools/gn/test_with_scheduler.h"
 #include "tools/gn/test_with_scope.h"
 #include "tools/gn/toolchain.h"
 #include "util/test/test.h"
@@ -59,7 +60,7 @@ class MockLoader : public Loader {
   std::vector<SourceFile> files_;
 };
 
-class BuilderTest : public testing::Test {
+class BuilderTest : public TestWithScheduler {
  public:
   BuilderTest()
       : loader_(new MockLoader),
@@ -242,4 +243,70 @@ TEST_F(BuilderTest, ConfigLoad) {
   EXPECT_TRUE(loader_->HasLoadedTwo(SourceFile("//b/BUILD.gn"), SourceFile("//b/BUILD.gn")));
 }
 
+// Tests that targets resolved on the worker pool end up in the same state as
+// targets resolved on the main thread.
+TEST_F(BuilderTest, ResolveOnWorkerPool) {
+  SourceDir toolchain_dir = settings_.toolchain_label().dir();
+  std::string toolchain_name = settings_.toolchain_label().name();
+
+  builder_.set_resolve_on_worker_pool(true);
+  std::vector<const BuilderRecord*> generated;
+  builder_.set_resolved_and_generated_callback(base::Bind(
+      [](std::vector<const BuilderRecord*>* generated,
+         const BuilderRecord* record) {
+        if (record->type() == BuilderRecord::ITEM_TARGET)
+          generated->push_back(record);
+      },
+      &generated));
+
+  DefineToolchain();
+
+  // A -> B -> C, defined in reverse dependency order.
+  Label a_label(SourceDir("//a/"), "a", toolchain_dir, toolchain_name);
+  Label b_label(SourceDir("//b/"), "b", toolchain_dir, toolchain_name);
+  Label c_label(SourceDir("//c/"), "c", toolchain_dir, toolchain_name);
+
+  Target* a = new Target(&settings_, a_label);
+  a->public_deps().push_back(LabelTargetPair(b_label));
+  a->set_output_type(Target::EXECUTABLE);
+  builder_.ItemDefined(std::unique_ptr<Item>(a));
+
+  Target* b = new Target(&settings_, b_label);
+  b->public_deps().push_back(LabelTargetPair(c_label));
+  b->set_output_type(Target::SHARED_LIBRARY);
+  b->visibility().SetPublic();
+  builder_.ItemDefined(std::unique_ptr<Item>(b));
+
+  Target* c = new Target(&settings_, c_label);
+  c->set_output_type(Target::STATIC_LIBRARY);
+  c->visibility().SetPublic();
+  builder_.ItemDefined(std::unique_ptr<Item>(c));
+
+  // C is being resolved on a worker, so nothing can be resolved yet.
+  BuilderRecord* a_record = builder_.GetRecord(a_label);
+  BuilderRecord* b_record = builder_.GetRecord(b_label);
+  BuilderRecord* c_record = builder_.GetRecord(c_label);
+  EXPECT_FALSE(b_record->resolved());
+  EXPECT_FALSE(a_record->resolved());
+
+  // The scheduler quits once the last resolution has been posted back.
+  EXPECT_TRUE(scheduler().Run());
+
+  EXPECT_TRUE(a_record->resolved());
+  EXPECT_TRUE(b_record->resolved());
+  EXPECT_TRUE(c_record->resolved());
+  EXPECT_TRUE(a_record->waiting_on_resolution().empty());
+  EXPECT_TRUE(b_record->waiting_on_resolution().empty());
+  EXPECT_TRUE(c_record->waiting_on_resolution().empty());
+
+  // Dependencies are resolved and generated before their dependents.
+  ASSERT_EQ(3u, generated.size());
+  EXPECT_EQ(c_record, generated[0]);
+  EXPECT_EQ(b_record, generated[1]);
+  EXPECT_EQ(a_record, generated[2]);
+
+  // A pulled the inherited library from C through B.
+  EXPECT_EQ(1u, a->inherited_libraries().GetOrdered().size());
+}
+
 }  // namespace gn_builder_unittest
@@ -9,6 +9,12 @@
 #include "base/strings/string_util.h"
 #include "tools/gn/input_file.h"
 #include "tools/gn/location.h"
+#include "util/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && (defined(__SSE2__) || defined(_M_X64))
+#include <emmintrin.h>
+#define C_INCLUDE_ITERATOR_USE_SSE2
+#endif
 
 namespace {
 
@@ -157,13 +163,34 @@ bool CIncludeIterator::GetNextIncludeString(base::StringPiece* out,
   return false;
 }
 
+// static
+size_t CIncludeIterator::FindNewline(const base::StringPiece& str,
+                                     size_t pos) {
+  const char* data = str.data();
+  const size_t size = str.size();
+#if defined(C_INCLUDE_ITERATOR_USE_SSE2)
+  // Skip whole blocks without a newline. The scalar loop below finds the
+  // newline within the block that has one.
+  const __m128i newline = _mm_set1_epi8('\n');
+  while (pos + sizeof(__m128i) <= size) {
+    __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)))
+      break;
+    pos += sizeof(__m128i);
+  }
+#endif
+  while (pos < size && data[pos] != '\n')
+    pos++;
+  return pos;
+}
+
 bool CIncludeIterator::GetNextLine(base::StringPiece* line, int* line_number) {
   if (offset_ == file_.size())
     return false;
 
   size_t begin = offset_;
-  while (offset_ < file_.size() && file_[offset_] != '\n')
-    offset_++;
+  offset_ = FindNewline(file_, offset_);
   line_number_++;
 
   *line = file_.substr(begin, offset_ - begin);
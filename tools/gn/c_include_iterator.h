@@ -32,6 +32,11 @@ class CIncludeIterator {
   // not count comments or preprocessor.
   static const int kMaxNonIncludeLines;
 
+  // Returns the offset of the first newline in |str| at or after |pos|, or
+  // the size of |str| if there is none. Scans 16 bytes at a time where SSE2
+  // is available.
+  static size_t FindNewline(const base::StringPiece& str, size_t pos);
+
  private:
   // Returns false on EOF, otherwise fills in the given line and the one-based
   // line number into *line_number;
@@ -21,6 +21,13 @@ bool RangeIs(const LocationRange& range,
          range.end().column_number() == end_char;
 }
 
+// The byte-at-a-time newline search that FindNewline() replaced.
+size_t ScalarFindNewline(const base::StringPiece& str, size_t pos) {
+  while (pos < str.size() && str[pos] != '\n')
+    pos++;
+  return pos;
+}
+
 }  // namespace
 
 TEST(CIncludeIterator, Basic) {
@@ -176,3 +183,18 @@ TEST(CIncludeIterator, SpacesAfterHash) {
 
   EXPECT_FALSE(iter.GetNextIncludeString(&contents, &range));
 }
+
+TEST(CIncludeIterator, FindNewline) {
+  // Cover newlines at every position around the 16-byte block boundaries.
+  for (size_t size = 0; size < 40; size++) {
+    for (size_t newline = 0; newline <= size; newline++) {
+      std::string buffer(size, 'x');
+      if (newline < size)
+        buffer[newline] = '\n';
+      for (size_t pos = 0; pos <= size; pos++) {
+        EXPECT_EQ(ScalarFindNewline(buffer, pos),
+                  CIncludeIterator::FindNewline(buffer, pos));
+      }
+    }
+  }
+}
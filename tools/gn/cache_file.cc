@@ -0,0 +1,187 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/cache_file.h"
+
+#include <string.h>
+
+#include <limits>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+
+namespace {
+
+const size_t kMagicSize = 4;
+
+}  // namespace
+
+CacheWriter::CacheWriter() = default;
+
+CacheWriter::~CacheWriter() = default;
+
+void CacheWriter::WriteVarint(uint64_t value) {
+  while (value >= 0x80) {
+    data_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  data_.push_back(static_cast<char>(value));
+}
+
+void CacheWriter::WriteString(const base::StringPiece& value) {
+  WriteVarint(value.size());
+  data_.append(value.data(), value.size());
+}
+
+void CacheWriter::WriteDigest(const base::MD5Digest& digest) {
+  data_.append(reinterpret_cast<const char*>(digest.a), sizeof(digest.a));
+}
+
+CacheReader::CacheReader(const base::StringPiece& data)
+    : data_(data), pos_(0) {}
+
+CacheReader::~CacheReader() = default;
+
+bool CacheReader::ReadVarint(uint64_t* value) {
+  uint64_t result = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (pos_ >= data_.size())
+      return false;
+    uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;  // Too many continuation bytes.
+}
+
+bool CacheReader::ReadInt(int* value) {
+  uint64_t result;
+  if (!ReadVarint(&result) ||
+      result > static_cast<uint64_t>(std::numeric_limits<int>::max()))
+    return false;
+  *value = static_cast<int>(result);
+  return true;
+}
+
+bool CacheReader::ReadString(base::StringPiece* value) {
+  uint64_t size;
+  if (!ReadVarint(&size) || size > data_.size() - pos_)
+    return false;
+  *value = data_.substr(pos_, static_cast<size_t>(size));
+  pos_ += static_cast<size_t>(size);
+  return true;
+}
+
+bool CacheReader::ReadDigest(base::MD5Digest* digest) {
+  if (data_.size() - pos_ < sizeof(digest->a))
+    return false;
+  memcpy(digest->a, data_.data() + pos_, sizeof(digest->a));
+  pos_ += sizeof(digest->a);
+  return true;
+}
+
+FileStamp::FileStamp() : size(-1), last_modified(0) {
+  memset(digest.a, 0, sizeof(digest.a));
+}
+
+bool FileStamp::SameContents(const FileStamp& other) const {
+  return size == other.size &&
+         memcmp(digest.a, other.digest.a, sizeof(digest.a)) == 0;
+}
+
+void FileStamp::Write(CacheWriter* writer) const {
+  writer->WriteVarint(static_cast<uint64_t>(size));
+  writer->WriteVarint(last_modified);
+  writer->WriteDigest(digest);
+}
+
+bool FileStamp::Read(CacheReader* reader) {
+  uint64_t read_size;
+  if (!reader->ReadVarint(&read_size) ||
+      !reader->ReadVarint(&last_modified) || !reader->ReadDigest(&digest))
+    return false;
+  size = static_cast<int64_t>(read_size);
+  return true;
+}
+
+bool GetFileStampForContents(const base::File::Info& info,
+                             const base::StringPiece& contents,
+                             FileStamp* stamp) {
+  if (info.size != static_cast<int64_t>(contents.size()))
+    return false;
+  stamp->size = static_cast<int64_t>(contents.size());
+  stamp->last_modified = info.last_modified;
+  base::MD5Sum(contents.data(), contents.size(), &stamp->digest);
+  return true;
+}
+
+bool GetFileStamp(const base::FilePath& path, FileStamp* stamp) {
+  base::File::Info info;
+  std::string contents;
+  if (!base::GetFileInfo(path, &info) ||
+      !base::ReadFileToString(path, &contents))
+    return false;
+  return GetFileStampForContents(info, contents, stamp);
+}
+
+bool ReadCacheFile(const base::FilePath& path,
+                   const char* magic,
+                   uint32_t version,
+                   std::string* body) {
+  DCHECK_EQ(kMagicSize, strlen(magic));
+
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return false;
+  if (contents.size() < kMagicSize ||
+      contents.compare(0, kMagicSize, magic) != 0)
+    return false;
+
+  CacheReader reader(base::StringPiece(contents).substr(kMagicSize));
+  uint64_t read_version;
+  if (!reader.ReadVarint(&read_version) || read_version != version)
+    return false;
+
+  // The version is a single varint right after the magic.
+  CacheWriter header;
+  header.WriteVarint(version);
+  body->assign(contents, kMagicSize + header.data().size(), std::string::npos);
+  return true;
+}
+
+bool WriteCacheFile(const base::FilePath& path,
+                    const char* magic,
+                    uint32_t version,
+                    const CacheWriter& body) {
+  DCHECK_EQ(kMagicSize, strlen(magic));
+
+  CacheWriter header;
+  header.WriteVarint(version);
+
+  std::string contents(magic, kMagicSize);
+  contents.append(header.data());
+  contents.append(body.data());
+
+  if (!base::CreateDirectory(path.DirName()))
+    return false;
+
+  // Write next to the destination and move into place so that a concurrent
+  // reader never sees a partially written cache.
+  base::FilePath temp_path(path.value() + FILE_PATH_LITERAL(".tmp"));
+  if (base::WriteFile(temp_path, contents.data(),
+                      static_cast<int>(contents.size())) !=
+      static_cast<int>(contents.size())) {
+    base::DeleteFile(temp_path, false);
+    return false;
+  }
+  if (!base::ReplaceFile(temp_path, path, nullptr)) {
+    base::DeleteFile(temp_path, false);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,112 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_CACHE_FILE_H_
+#define TOOLS_GN_CACHE_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "base/files/file.h"
+#include "base/macros.h"
+#include "base/md5.h"
+#include "base/strings/string_piece.h"
+#include "util/ticks.h"
+
+namespace base {
+class FilePath;
+}
+
+// Helpers for the binary cache files that GN keeps in the build directory
+// between runs.
+//
+// A cache file starts with a 4-character magic string and a format version,
+// followed by a body whose layout is up to the user. Integers are stored as
+// base-128 varints. The contents of a cache file are never trusted: a reader
+// fails on any out-of-bounds read, and callers treat a failed read like an
+// empty cache.
+
+class CacheWriter {
+ public:
+  CacheWriter();
+  ~CacheWriter();
+
+  void WriteVarint(uint64_t value);
+  void WriteString(const base::StringPiece& value);
+  void WriteDigest(const base::MD5Digest& digest);
+
+  const std::string& data() const { return data_; }
+
+ private:
+  std::string data_;
+
+  DISALLOW_COPY_AND_ASSIGN(CacheWriter);
+};
+
+class CacheReader {
+ public:
+  // The data must outlive the reader. Strings read from the reader point
+  // into it.
+  explicit CacheReader(const base::StringPiece& data);
+  ~CacheReader();
+
+  bool ReadVarint(uint64_t* value);
+  bool ReadInt(int* value);
+  bool ReadString(base::StringPiece* value);
+  bool ReadDigest(base::MD5Digest* digest);
+
+  bool at_end() const { return pos_ == data_.size(); }
+
+ private:
+  base::StringPiece data_;
+  size_t pos_;
+
+  DISALLOW_COPY_AND_ASSIGN(CacheReader);
+};
+
+// Identifies one version of a file on disk. Two stamps are considered equal
+// if the size and contents digest match; the modification time lets callers
+// avoid hashing files that were not touched.
+struct FileStamp {
+  FileStamp();
+
+  int64_t size;
+  Ticks last_modified;
+  base::MD5Digest digest;
+
+  bool SameContents(const FileStamp& other) const;
+
+  void Write(CacheWriter* writer) const;
+  bool Read(CacheReader* reader);
+};
+
+// Fills in the stamp of a file from |info| and |contents|. The file must be
+// stat'ed into |info| before it is read into |contents|: then a change while
+// reading leaves the file newer than the stamp, and a later lookup compares
+// the contents instead of trusting the time. Returns false if the sizes
+// differ, meaning the file changed in between.
+bool GetFileStampForContents(const base::File::Info& info,
+                             const base::StringPiece& contents,
+                             FileStamp* stamp);
+
+// Stats, reads and hashes the file at |path|. Returns false if it can't be
+// read or changed in between.
+bool GetFileStamp(const base::FilePath& path, FileStamp* stamp);
+
+// Reads the cache file at |path| and returns its body in |body|. Returns false
+// if the file doesn't exist or doesn't match |magic| and |version|.
+bool ReadCacheFile(const base::FilePath& path,
+                   const char* magic,
+                   uint32_t version,
+                   std::string* body);
+
+// Writes a cache file with the given |body|. Returns false on I/O failure.
+bool WriteCacheFile(const base::FilePath& path,
+                    const char* magic,
+                    uint32_t version,
+                    const CacheWriter& body);
+
+#endif  // TOOLS_GN_CACHE_FILE_H_
@@ -2,13 +2,18 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdio.h>
+
 #include <algorithm>
 #include <iterator>
 #include <set>
+#include <string>
 #include <vector>
 
+#include "base/command_line.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/scoped_file.h"
 #include "tools/gn/analyzer.h"
 #include "tools/gn/commands.h"
 #include "tools/gn/filesystem_utils.h"
@@ -91,9 +96,128 @@ const char kAnalyze_Help[] =
   "error" key is non-empty and a non-fatal error occurred. In other words, it
   tries really hard to always write something to the output JSON and convey
   errors that way rather than via return codes.
+
+Batch mode
+
+  gn analyze <out_dir> --batch <input_path> <output_path>
+
+  Answers many requests against one loaded build graph. Each line of the input
+  is a JSON object as described above, and the result for each is written to
+  the output as one line of JSON, in the same order. Empty lines are skipped.
+  Either path may be "-" to use stdin or stdout, except in "gn server".
+
+  Each result is written out and flushed as soon as it is computed, so another
+  program can keep the command running and send it requests one at a time.
 )";
 
+namespace {
+
+const char kSwitchBatch[] = "batch";
+
+// Reads the next line of |file| into |line|, without the line ending. Returns
+// false at the end of the file.
+bool ReadLine(FILE* file, std::string* line) {
+  line->clear();
+  char buffer[4096];
+  while (fgets(buffer, sizeof(buffer), file)) {
+    line->append(buffer);
+    if (!line->empty() && line->back() == '\n') {
+      line->pop_back();
+      if (!line->empty() && line->back() == '\r')
+        line->pop_back();
+      return true;
+    }
+  }
+  return !line->empty();
+}
+
+int RunAnalyzeBatch(const std::vector<std::string>& args) {
+  // Inside "gn server" the command runs in the server process, whose stdin and
+  // stdout aren't connected to the client.
+  if (HasPreloadedSetup() && (args[1] == "-" || args[2] == "-")) {
+    Err(Location(), "Can't use \"-\" in gn server.",
+        "Give the input and output of \"gn analyze --batch\" as files.")
+        .PrintToStdout();
+    return 1;
+  }
+
+  base::ScopedFILE input_file;
+  FILE* input = stdin;
+  if (args[1] != "-") {
+    input_file.reset(base::OpenFile(CommandLinePathToFilePath(args[1]), "rb"));
+    if (!input_file) {
+      Err(Location(), "Input file " + args[1] + " not found.").PrintToStdout();
+      return 1;
+    }
+    input = input_file.get();
+  }
+
+  Setup* setup = LoadBuildDir(args[0]);
+  if (!setup)
+    return 1;
+
+  base::ScopedFILE output_file;
+  FILE* output = stdout;
+  if (args[2] != "-") {
+    output_file.reset(base::OpenFile(CommandLinePathToFilePath(args[2]), "wb"));
+    if (!output_file) {
+      Err(Location(), "Unable to write file.",
+          "I was writing \"" + args[2] + "\".")
+          .PrintToStdout();
+      return 1;
+    }
+    output = output_file.get();
+  }
+
+  // The graph is loaded and indexed once for all the requests.
+  Analyzer analyzer(
+      setup->builder(), setup->build_settings().build_config_file(),
+      setup->GetDotFile(),
+      setup->build_settings().build_args().build_args_dependency_files());
+  return AnalyzeBatch(analyzer, input, output, args[2]);
+}
+
+}  // namespace
+
+int AnalyzeBatch(const Analyzer& analyzer,
+                 FILE* input,
+                 FILE* output,
+                 const std::string& output_name) {
+  std::string line;
+  while (ReadLine(input, &line)) {
+    if (line.find_first_not_of(" \t") == std::string::npos)
+      continue;
+
+    Err err;
+    std::string response = analyzer.Analyze(line, &err);
+    if (err.has_error()) {
+      err.PrintToStdout();
+      return 1;
+    }
+    response.push_back('\n');
+    if (fwrite(response.data(), 1, response.size(), output) !=
+            response.size() ||
+        fflush(output) != 0) {
+      Err(Location(), "Unable to write file.",
+          "I was writing \"" + output_name + "\".")
+          .PrintToStdout();
+      return 1;
+    }
+  }
+  return 0;
+}
+
 int RunAnalyze(const std::vector<std::string>& args) {
+  if (base::CommandLine::ForCurrentProcess()->HasSwitch(kSwitchBatch)) {
+    if (args.size() != 3) {
+      Err(Location(), "You're holding it wrong.",
+          "Usage: \"gn analyze <out_dir> --batch <input_path> <output_path>")
+          .PrintToStdout();
+      return 1;
+    }
+    return RunAnalyzeBatch(args);
+  }
+
   if (args.size() != 3) {
     Err(Location(), "You're holding it wrong.",
         "Usage: \"gn analyze <out_dir> <input_path> <output_path>")
@@ -102,15 +226,14 @@ int RunAnalyze(const std::vector<std::string>& args) {
   }
 
   std::string input;
-  bool ret = base::ReadFileToString(UTF8ToFilePath(args[1]), &input);
+  bool ret = base::ReadFileToString(CommandLinePathToFilePath(args[1]), &input);
   if (!ret) {
     Err(Location(), "Input file " + args[1] + " not found.").PrintToStdout();
     return 1;
   }
 
-  // Deliberately leaked to avoid expensive process teardown.
-  Setup* setup = new Setup;
-  if (!setup->DoSetup(args[0], false) || !setup->Run())
+  Setup* setup = LoadBuildDir(args[0]);
+  if (!setup)
     return 1;
 
   Err err;
@@ -124,7 +247,7 @@ int RunAnalyze(const std::vector<std::string>& args) {
     return 1;
   }
 
-  WriteFile(UTF8ToFilePath(args[2]), output, &err);
+  WriteFile(CommandLinePathToFilePath(args[2]), output, &err);
   if (err.has_error()) {
     err.PrintToStdout();
     return 1;
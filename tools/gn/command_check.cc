@@ -7,7 +7,9 @@
 #include "base/command_line.h"
 #include "base/strings/stringprintf.h"
 #include "tools/gn/commands.h"
+#include "tools/gn/build_settings.h"
 #include "tools/gn/header_checker.h"
+#include "tools/gn/include_scan_cache.h"
 #include "tools/gn/setup.h"
 #include "tools/gn/standard_out.h"
 #include "tools/gn/switches.h"
@@ -16,6 +18,12 @@
 
 namespace commands {
 
+namespace {
+
+const char kIncludeScanCacheFileName[] = "gn_includes.cache";
+
+}  // namespace
+
 const char kNoGnCheck_Help[] =
     R"(nogncheck: Skip an include line from checking.
 
@@ -87,7 +95,10 @@ What gets checked
   For targets being checked:
 
     - GN opens all C-like source files in the targets to be checked and scans
-      the top for includes.
+      the top for includes. The includes found are cached in the file
+      "gn_includes.cache" in the build directory, so files whose size and
+      modification time (or contents) didn't change since the last check are
+      not read again.
 
     - Includes with a "nogncheck" annotation are skipped (see
       "gn help nogncheck").
@@ -219,7 +230,7 @@ int RunCheck(const std::vector<std::string>& args) {
   bool check_generated = cmdline->HasSwitch("check-generated");
 
   if (!CheckPublicHeaders(&setup->build_settings(), all_targets,
-                          targets_to_check, force, check_generated))
+                          targets_to_check, force, check_generated, nullptr))
     return 1;
 
   if (!base::CommandLine::ForCurrentProcess()->HasSwitch(switches::kQuiet)) {
@@ -236,17 +247,35 @@ int RunCheck(const std::vector<std::string>& args) {
   return 0;
 }
 
+std::unique_ptr<IncludeScanCache> MakeIncludeScanCache(
+    const BuildSettings* build_settings) {
+  return std::make_unique<IncludeScanCache>(build_settings->GetFullPath(
+      SourceFile(build_settings->build_dir().value() +
+                 kIncludeScanCacheFileName)));
+}
+
 bool CheckPublicHeaders(const BuildSettings* build_settings,
                         const std::vector<const Target*>& all_targets,
                         const std::vector<const Target*>& to_check,
-                        bool force_check, bool check_generated) {
+                        bool force_check, bool check_generated,
+                        IncludeScanCache* include_scan_cache) {
   ScopedTrace trace(TraceItem::TRACE_CHECK_HEADERS, "Check headers");
 
+  std::unique_ptr<IncludeScanCache> owned_include_scan_cache;
+  if (!include_scan_cache) {
+    owned_include_scan_cache = MakeIncludeScanCache(build_settings);
+    owned_include_scan_cache->Load();
+    include_scan_cache = owned_include_scan_cache.get();
+  }
+
   scoped_refptr<HeaderChecker> header_checker(
       new HeaderChecker(build_settings, all_targets, check_generated));
+  header_checker->set_include_scan_cache(include_scan_cache);
 
   std::vector<Err> header_errors;
   header_checker->Run(to_check, force_check, &header_errors);
+  if (owned_include_scan_cache)
+    owned_include_scan_cache->Save();
   for (size_t i = 0; i < header_errors.size(); i++) {
     if (i > 0)
       OutputString("___________________\n", DECORATION_YELLOW);
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <mutex>
+#include <set>
 
 #include "base/bind.h"
 #include "base/command_line.h"
@@ -13,7 +14,11 @@
 #include "tools/gn/commands.h"
 #include "tools/gn/compile_commands_writer.h"
 #include "tools/gn/eclipse_writer.h"
+#include "tools/gn/header_checker.h"
+#include "tools/gn/include_scan_cache.h"
 #include "tools/gn/json_project_writer.h"
+#include "tools/gn/label_pattern.h"
+#include "tools/gn/ninja_target_cache.h"
 #include "tools/gn/ninja_target_writer.h"
 #include "tools/gn/ninja_writer.h"
 #include "tools/gn/qt_creator_writer.h"
@@ -43,7 +48,9 @@ const char kSwitchIdeValueVs2017[] = "vs2017";
 const char kSwitchIdeValueWinSdk[] = "winsdk";
 const char kSwitchIdeValueXcode[] = "xcode";
 const char kSwitchIdeValueJson[] = "json";
+const char kSwitchIncremental[] = "incremental";
 const char kSwitchNinjaExtraArgs[] = "ninja-extra-args";
+const char kSwitchNinjaShards[] = "ninja-shards";
 const char kSwitchNoDeps[] = "no-deps";
 const char kSwitchRootTarget[] = "root-target";
 const char kSwitchSln[] = "sln";
@@ -55,15 +62,34 @@ const char kSwitchJsonIdeScriptInterpreter[] = "json-ide-script-interpreter";
 const char kSwitchExportCompileCommands[] = "export-compile-commands";
 const char kSwitchExportCompileCommandsPerToolchain[] = "export-compile-commands-per-toolchain";
 
+const int kMaxNinjaShards = 1024;
+
+// Name of the file in the build directory used by --incremental.
+const char kNinjaTargetCacheFileName[] = "gn_targets.cache";
+
 // Collects Ninja rules for each toolchain. The lock protectes the rules.
 struct TargetWriteInfo {
   std::mutex lock;
   NinjaWriter::PerToolchainRules rules;
+
+  // Null unless --incremental was passed.
+  NinjaTargetCache* target_cache = nullptr;
+
+  // Null unless --check was passed. The files of the targets to check are
+  // scanned into it as soon as each target is resolved.
+  IncludeScanCache* include_scan_cache = nullptr;
+  const std::vector<LabelPattern>* check_patterns = nullptr;
 };
 
 // Called on worker thread to write the ninja file.
 void BackgroundDoWrite(TargetWriteInfo* write_info, const Target* target) {
-  std::string rule = NinjaTargetWriter::RunAndWriteFile(target);
+  NinjaTargetCache* target_cache = write_info->target_cache;
+  std::string rule;
+  if (!target_cache || !target_cache->Lookup(target, &rule)) {
+    rule = NinjaTargetWriter::RunAndWriteFile(target);
+    if (target_cache)
+      target_cache->Add(target, rule);
+  }
   DCHECK(!rule.empty());
 
   {
@@ -81,6 +107,37 @@ void ItemResolvedAndGeneratedCallback(TargetWriteInfo* write_info,
   if (target) {
     g_scheduler->ScheduleWork(
         base::Bind(&BackgroundDoWrite, write_info, target));
+
+    // Read the files for the header check in parallel with loading and
+    // writing the other targets. The check itself needs all targets.
+    if (write_info->include_scan_cache && target->IsBinary() &&
+        target->check_includes() &&
+        (!write_info->check_patterns ||
+         LabelPattern::VectorMatches(*write_info->check_patterns,
+                                     target->label()))) {
+      g_scheduler->ScheduleWork(base::Bind(
+          &HeaderChecker::ScanTargetIncludes,
+          target->settings()->build_settings(), target,
+          write_info->include_scan_cache));
+    }
+  }
+}
+
+// Called on the main thread after loading when one of the files read by
+// exec_script or read_file changed. Targets that were taken from the cache
+// during loading may depend on them, so write them again.
+void RewriteCachedTargets(TargetWriteInfo* write_info) {
+  std::vector<const Target*> cached =
+      write_info->target_cache->GetCachedTargets();
+  std::set<const Target*> cached_set(cached.begin(), cached.end());
+  for (auto& cur_toolchain : write_info->rules) {
+    for (auto& target_rule : cur_toolchain.second) {
+      if (cached_set.find(target_rule.first) == cached_set.end())
+        continue;
+      const Target* target = target_rule.first;
+      target_rule.second = NinjaTargetWriter::RunAndWriteFile(target);
+      write_info->target_cache->Add(target, target_rule.second);
+    }
   }
 }
 
@@ -316,7 +373,8 @@ const char kGen_HelpShort[] = "gen: Generate ninja files.";
 const char kGen_Help[] =
     R"(gn gen: Generate ninja files.
 
-  gn gen [--check] [--envlog=<file_name>] [<ide options>] <out_dir>
+  gn gen [--check] [--envlog=<file_name>] [--incremental]
+         [--ninja-shards=<n>] [<ide options>] <out_dir>
 
   Generates ninja files from the current tree and puts them in the given output
   directory.
@@ -327,7 +385,8 @@ const char kGen_Help[] =
       out/foo
 
   "gn gen --check" is the same as running "gn check". See "gn help check"
-  for documentation on that mode.
+  for documentation on that mode. The source files to check are read while
+  the targets are still loading, and share the include cache of "gn check".
 
   See "gn help switches" for the common command-line switches.
 
@@ -338,6 +397,24 @@ Options
       will show a list of environment variables referenced in gn files as
       well as their values.
 
+  --incremental
+      Remembers the ninja rules written for each target in the file
+      "gn_targets.cache" in the build directory. On the next run with this
+      flag, targets whose build files, dependencies, configs and toolchain
+      are unchanged are not written again. Changing the GN version, the .gn
+      file, the build config file or the build arguments invalidates the
+      whole cache.
+
+      Since ninja passes the same flags when it re-runs GN, this mostly
+      speeds up automatic regeneration of the build files.
+
+  --ninja-shards=<n>
+      Splits the target rules of each toolchain.ninja file into <n> files
+      named "toolchain.<i>.ninja", and the phony rules of build.ninja into
+      "build.<i>.ninja", which the main files load with "subninja". Each
+      target always goes to the same file, and files whose contents didn't
+      change aren't rewritten. The default is 1, which writes no extra files.
+
 IDE options
 
   GN optionally generates files for IDE. Possibilities for <ide options>
@@ -480,15 +557,60 @@ int RunGen(const std::vector<std::string>& args) {
   if (command_line->HasSwitch(kSwitchCheck))
     setup->set_check_public_headers(true);
 
+  if (command_line->HasSwitch(kSwitchNinjaShards)) {
+    std::string value = command_line->GetSwitchValueASCII(kSwitchNinjaShards);
+    int shard_count = 0;
+    if (!base::StringToInt(value, &shard_count) || shard_count < 1 ||
+        shard_count > kMaxNinjaShards) {
+      Err(Location(), "Invalid --" + std::string(kSwitchNinjaShards) + ".",
+          "Expected a number from 1 to " +
+              base::IntToString(kMaxNinjaShards) + ", got \"" + value +
+              "\".")
+          .PrintToStdout();
+      return 1;
+    }
+    setup->build_settings().set_ninja_shard_count(shard_count);
+  }
+
   // Cause the load to also generate the ninja files for each target.
   TargetWriteInfo write_info;
   setup->builder().set_resolved_and_generated_callback(
       base::Bind(&ItemResolvedAndGeneratedCallback, &write_info));
 
-  // Do the actual load. This will also write out the target ninja files.
-  if (!setup->Run())
+  // Deliberately leaked along with the setup.
+  NinjaTargetCache* target_cache = nullptr;
+  if (command_line->HasSwitch(kSwitchIncremental)) {
+    target_cache = new NinjaTargetCache(
+        &setup->build_settings(),
+        setup->build_settings().GetFullPath(
+            SourceFile(setup->build_settings().build_dir().value() +
+                       kNinjaTargetCacheFileName)));
+    target_cache->Load();
+    write_info.target_cache = target_cache;
+  }
+
+  // Deliberately leaked along with the setup.
+  IncludeScanCache* include_scan_cache = nullptr;
+  if (command_line->HasSwitch(kSwitchCheck)) {
+    include_scan_cache =
+        commands::MakeIncludeScanCache(&setup->build_settings()).release();
+    include_scan_cache->Load();
+    setup->set_include_scan_cache(include_scan_cache);
+    write_info.include_scan_cache = include_scan_cache;
+    write_info.check_patterns = setup->check_patterns();
+  }
+
+  // Do the actual load. This will also write out the target ninja files and
+  // run the header check when requested.
+  bool success = setup->Run();
+  if (include_scan_cache)
+    include_scan_cache->Save();
+  if (!success)
     return 1;
 
+  if (target_cache && target_cache->GenDependenciesChanged())
+    RewriteCachedTargets(&write_info);
+
   // Sort the targets in each toolchain according to their label. This makes
   // the ninja files have deterministic content.
   for (auto& cur_toolchain : write_info.rules) {
@@ -507,6 +629,9 @@ int RunGen(const std::vector<std::string>& args) {
     return 1;
   }
 
+  if (target_cache)
+    target_cache->Save();
+
   if (env_logging) {
     std::string file_name = command_line->GetSwitchValueASCII(kSwitchEnvlog);
     SourceFile envlog = setup->build_settings().build_dir().ResolveRelativeFile(
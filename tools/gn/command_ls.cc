@@ -69,9 +69,8 @@ int RunLs(const std::vector<std::string>& args) {
     return 1;
   }
 
-  // Deliberately leaked to avoid expensive process teardown.
-  Setup* setup = new Setup;
-  if (!setup->DoSetup(args[0], false) || !setup->Run())
+  Setup* setup = LoadBuildDir(args[0]);
+  if (!setup)
     return 1;
 
   const base::CommandLine* cmdline = base::CommandLine::ForCurrentProcess();
@@ -321,11 +321,8 @@ int RunPath(const std::vector<std::string>& args) {
     return 1;
   }
 
-  // Deliberately leaked to avoid expensive process teardown.
-  Setup* setup = new Setup;
-  if (!setup->DoSetup(args[0], false))
-    return 1;
-  if (!setup->Run())
+  Setup* setup = LoadBuildDir(args[0]);
+  if (!setup)
     return 1;
 
   const Target* target1 = ResolveTargetFromCommandLineString(setup, args[1]);
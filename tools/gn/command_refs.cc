@@ -412,9 +412,8 @@ int RunRefs(const std::vector<std::string>& args) {
   bool all = cmdline->HasSwitch("all");
   bool all_toolchains = cmdline->HasSwitch(switches::kAllToolchains);
 
-  // Deliberately leaked to avoid expensive process teardown.
-  Setup* setup = new Setup;
-  if (!setup->DoSetup(args[0], false) || !setup->Run())
+  Setup* setup = LoadBuildDir(args[0]);
+  if (!setup)
     return 1;
 
   // The inputs are everything but the first arg (which is the build dir).
@@ -423,8 +422,8 @@ int RunRefs(const std::vector<std::string>& args) {
     if (args[i][0] == '@') {
       // The argument is as a path to a response file.
       std::string contents;
-      bool ret =
-          base::ReadFileToString(UTF8ToFilePath(args[i].substr(1)), &contents);
+      bool ret = base::ReadFileToString(
+          CommandLinePathToFilePath(args[i].substr(1)), &contents);
       if (!ret) {
         Err(Location(), "Response file " + args[i].substr(1) + " not found.")
             .PrintToStdout();
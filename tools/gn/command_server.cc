@@ -0,0 +1,475 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/command_server.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/strings/string_number_conversions.h"
+#include "tools/gn/commands.h"
+#include "tools/gn/filesystem_utils.h"
+#include "tools/gn/input_file_manager.h"
+#include "tools/gn/setup.h"
+#include "tools/gn/standard_out.h"
+#include "tools/gn/switches.h"
+#include "util/build_config.h"
+#include "util/msg_loop.h"
+
+#if !defined(OS_WIN)
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace commands {
+
+const char kServer[] = "server";
+const char kServer_HelpShort[] =
+    "server: Keep the build loaded and answer queries about it.";
+const char kServer_Help[] =
+    R"(gn server: Keep the build loaded and answer queries about it.
+
+  gn server <out_dir>
+  gn server <out_dir> -- <command> [<args>...]
+  gn server <out_dir> -- stop
+
+  The first form loads the build files for the given build directory once and
+  then waits for requests on the Unix domain socket "gn_server.sock" in the
+  build directory. It runs until it's stopped.
+
+  The second form sends a command to the server for the build directory and
+  prints its output. The command is run on the already loaded build, so it
+  doesn't have to run the build files again. The build directory is implied
+  and must not be repeated in <args>. Only commands that read the build graph
+  can be sent: analyze, desc, ls, meta, path and refs. Relative paths and
+  labels are resolved against the current directory of the client.
+
+  The third form asks the server to exit.
+
+  Before answering a request, the server checks whether any of the build
+  files, the .gn file, the args file or the files read by exec_script and
+  read_file changed since the build was loaded. If so, it loads the build
+  again. The server always uses the parse cache (see "gn help --parse-cache")
+  so that only changed files are parsed again.
+
+  Only files that were read are watched. Creating a file doesn't cause a
+  reload, even if it would be used instead of a file that was read, like a
+  build file in the source tree shadowing one in the secondary source tree.
+  Restart the server or touch a watched file in that case.
+
+  Not supported on Windows.
+
+Protocol
+
+  A client connects to the socket, sends its current directory, the command
+  and the command's arguments, each terminated by a NUL character, and then
+  shuts down its side of the connection for writing. The server replies with
+  the exit code of the command in decimal followed by a newline, then the
+  output of the command, and closes the connection.
+
+  Requests are answered one at a time. A client that stalls for 10 seconds
+  while sending its request or reading the reply is disconnected.
+
+Examples
+
+  gn server out/Debug &
+  gn server out/Debug -- desc //base cflags --format=json
+  gn server out/Debug -- refs //base --all
+  gn server out/Debug -- stop
+)";
+
+namespace {
+
+const char kStopCommand[] = "stop";
+
+// Commands that only read the build graph can be answered by the server.
+bool IsServedCommand(const std::string& command) {
+  static const char* const kServedCommands[] = {kAnalyze, kDesc, kLs,
+                                                kMeta,    kPath, kRefs};
+  for (const char* served : kServedCommands) {
+    if (command == served)
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+Server::Server(const std::string& build_dir, const base::CommandLine& cmdline)
+    : build_dir_(build_dir), cmdline_(cmdline), loaded_(false) {
+  // Reloads only need to parse the files that changed.
+  cmdline_.AppendSwitch(switches::kParseCache);
+}
+
+Server::~Server() = default;
+
+bool Server::Load() {
+  // Only one Setup (and Scheduler) can exist at a time.
+  setup_.reset();
+
+  load_output_.clear();
+  SetOutputCapture(&load_output_);
+  setup_ = std::make_unique<Setup>();
+  loaded_ = setup_->DoSetup(build_dir_, false, cmdline_) &&
+            setup_->Run(cmdline_);
+  SetOutputCapture(nullptr);
+
+  // A failed load quits without waiting for the work it posted to the main
+  // thread, which refers to |setup_| and must not run during the next load.
+  MsgLoop::Current()->DiscardPendingTasks();
+
+  // Also watch the files of a failed load so that fixing them is noticed.
+  RecordWatchedFiles();
+  return loaded_;
+}
+
+std::string Server::HandleRequest(const std::string& request, bool* stop) {
+  // The request is a list of NUL-terminated strings: the client's directory,
+  // the command and its arguments.
+  std::vector<std::string> parts;
+  size_t begin = 0;
+  for (size_t i = 0; i < request.size(); i++) {
+    if (request[i] == '\0') {
+      parts.push_back(request.substr(begin, i - begin));
+      begin = i + 1;
+    }
+  }
+  if (parts.size() < 2 || begin != request.size())
+    return "1\nInvalid request.\n";
+
+  const std::string& command = parts[1];
+  if (command == kStopCommand) {
+    *stop = true;
+    return "0\n";
+  }
+  if (!IsServedCommand(command)) {
+    return "1\nThe command \"" + command +
+           "\" can't be sent to gn server. See \"gn help server\".\n";
+  }
+
+  base::FilePath client_dir = UTF8ToFilePath(parts[0]);
+  if (!client_dir.IsAbsolute() || !base::DirectoryExists(client_dir))
+    return "1\nThe directory " + parts[0] + " doesn't exist.\n";
+
+  if (WatchedFilesChanged())
+    Load();
+  if (!loaded_)
+    return "1\n" + load_output_;
+
+  // The command sees a command line as if it were invoked directly on the
+  // build directory.
+  base::CommandLine::StringVector argv;
+  argv.push_back(cmdline_.GetProgram().value());
+  argv.push_back(command);
+  argv.push_back(build_dir_);
+  argv.insert(argv.end(), parts.begin() + 2, parts.end());
+  base::CommandLine request_cmdline(argv);
+
+  base::CommandLine* process_cmdline = base::CommandLine::ForCurrentProcess();
+  base::CommandLine saved_cmdline = *process_cmdline;
+  *process_cmdline = request_cmdline;
+
+  std::vector<std::string> args = request_cmdline.GetArgs();
+  args.erase(args.begin());  // The command.
+
+  std::string output;
+  SetOutputCapture(&output);
+  SetPreloadedSetup(setup_.get());
+  SetCommandDirectory(client_dir);
+  int exit_code = GetCommands().find(command)->second.runner(args);
+  SetCommandDirectory(base::FilePath());
+  SetPreloadedSetup(nullptr);
+  SetOutputCapture(nullptr);
+
+  *process_cmdline = saved_cmdline;
+  return base::IntToString(exit_code) + "\n" + output;
+}
+
+// static
+Server::WatchedFile Server::StatFile(const base::FilePath& path) {
+  WatchedFile file;
+  file.path = path;
+  base::File::Info info;
+  if (base::GetFileInfo(path, &info)) {
+    file.size = info.size;
+    file.last_modified = info.last_modified;
+  } else {
+    file.size = -1;
+    file.last_modified = 0;
+  }
+  return file;
+}
+
+void Server::RecordWatchedFiles() {
+  std::vector<base::FilePath> paths;
+  paths.push_back(setup_->build_settings().dotfile_path());
+  setup_->scheduler().input_file_manager()->GetAllPhysicalInputFileNames(
+      &paths);
+  std::vector<base::FilePath> other_files =
+      setup_->scheduler().GetGenDependencies();
+  paths.insert(paths.end(), other_files.begin(), other_files.end());
+
+  std::sort(paths.begin(), paths.end());
+  paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+  watched_files_.clear();
+  for (const base::FilePath& path : paths) {
+    if (!path.empty())
+      watched_files_.push_back(StatFile(path));
+  }
+}
+
+bool Server::WatchedFilesChanged() const {
+  for (const WatchedFile& watched : watched_files_) {
+    WatchedFile current = StatFile(watched.path);
+    if (current.size != watched.size ||
+        current.last_modified != watched.last_modified)
+      return true;
+  }
+  return false;
+}
+
+#if defined(OS_WIN)
+
+int RunServer(const std::vector<std::string>& args) {
+  Err(Location(), "\"gn server\" is not supported on Windows.")
+      .PrintToStdout();
+  return 1;
+}
+
+#else  // !defined(OS_WIN)
+
+namespace {
+
+const char kSocketFileName[] = "gn_server.sock";
+
+// Requests are small, so anything larger is not a valid request.
+const size_t kMaxRequestSize = 1024 * 1024;
+
+// Requests are answered one at a time, so a client that stalls would block
+// all the others.
+const int kClientTimeoutSeconds = 10;
+
+bool WriteAll(int fd, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t result = HANDLE_EINTR(
+        write(fd, data.data() + written, data.size() - written));
+    if (result <= 0)
+      return false;
+    written += static_cast<size_t>(result);
+  }
+  return true;
+}
+
+bool ReadAll(int fd, size_t max_size, std::string* data) {
+  char buffer[4096];
+  while (true) {
+    ssize_t result = HANDLE_EINTR(read(fd, buffer, sizeof(buffer)));
+    if (result < 0)
+      return false;
+    if (result == 0)
+      return true;
+    data->append(buffer, static_cast<size_t>(result));
+    if (data->size() > max_size)
+      return false;
+  }
+}
+
+// Fills in the address of the socket at |path|. Returns false if the path is
+// too long for a socket address.
+bool GetSocketAddress(const base::FilePath& path, sockaddr_un* address) {
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  if (path.value().size() >= sizeof(address->sun_path))
+    return false;
+  strncpy(address->sun_path, path.value().c_str(),
+          sizeof(address->sun_path) - 1);
+  return true;
+}
+
+// Connects to the socket at |path|. Returns -1 on failure.
+int ConnectToSocket(const base::FilePath& path) {
+  sockaddr_un address;
+  if (!GetSocketAddress(path, &address))
+    return -1;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  if (HANDLE_EINTR(connect(fd, reinterpret_cast<sockaddr*>(&address),
+                           sizeof(address))) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Returns the socket for the given build directory, or an empty path on
+// failure, in which case the error has been printed.
+base::FilePath GetSocketPath(const std::string& build_dir) {
+  // Only the .gn file is needed to locate the build directory.
+  Setup setup;
+  setup.set_fill_arguments(false);
+  if (!setup.DoSetup(build_dir, false))
+    return base::FilePath();
+  return setup.build_settings()
+      .GetFullPath(setup.build_settings().build_dir())
+      .AppendASCII(kSocketFileName);
+}
+
+// Sends one request to the server and prints the reply.
+int RunClient(const base::FilePath& socket_path,
+              const std::vector<std::string>& request_args) {
+  int fd = ConnectToSocket(socket_path);
+  if (fd < 0) {
+    Err(Location(), "No gn server is running.",
+        "Couldn't connect to " + FilePathToUTF8(socket_path) +
+            "\nStart one with \"gn server <out_dir>\".")
+        .PrintToStdout();
+    return 1;
+  }
+
+  base::FilePath cwd;
+  base::GetCurrentDirectory(&cwd);
+  std::string request = FilePathToUTF8(cwd);
+  request.push_back('\0');
+  for (const std::string& arg : request_args) {
+    request.append(arg);
+    request.push_back('\0');
+  }
+
+  std::string reply;
+  bool ok = WriteAll(fd, request) && shutdown(fd, SHUT_WR) == 0 &&
+            ReadAll(fd, std::numeric_limits<size_t>::max(), &reply);
+  close(fd);
+
+  size_t newline = reply.find('\n');
+  int exit_code = 1;
+  if (!ok || newline == std::string::npos ||
+      !base::StringToInt(base::StringPiece(reply.data(), newline),
+                         &exit_code)) {
+    Err(Location(), "Invalid reply from the gn server.").PrintToStdout();
+    return 1;
+  }
+  OutputString(reply.substr(newline + 1), DECORATION_NONE, NO_ESCAPING);
+  return exit_code;
+}
+
+// Listens on the socket at |socket_path| and answers requests with |server|
+// until a stop request arrives. Returns false if the socket can't be created.
+bool Serve(Server* server, const base::FilePath& socket_path) {
+  sockaddr_un address;
+  if (!GetSocketAddress(socket_path, &address)) {
+    Err(Location(), "The path of the server socket is too long.",
+        FilePathToUTF8(socket_path))
+        .PrintToStdout();
+    return false;
+  }
+
+  // A socket file without a server behind it is left over from a server that
+  // was killed.
+  int existing = ConnectToSocket(socket_path);
+  if (existing >= 0) {
+    close(existing);
+    Err(Location(), "A gn server is already running for this directory.")
+        .PrintToStdout();
+    return false;
+  }
+  base::DeleteFile(socket_path, false);
+
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0 ||
+      bind(listen_fd, reinterpret_cast<sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(listen_fd, SOMAXCONN) != 0) {
+    Err(Location(), "Couldn't create the server socket.",
+        FilePathToUTF8(socket_path) + ": " + strerror(errno))
+        .PrintToStdout();
+    if (listen_fd >= 0)
+      close(listen_fd);
+    return false;
+  }
+
+  // Clients that go away while the reply is written shouldn't kill us.
+  signal(SIGPIPE, SIG_IGN);
+
+  bool stop = false;
+  while (!stop) {
+    int fd = HANDLE_EINTR(accept(listen_fd, nullptr, nullptr));
+    if (fd < 0)
+      continue;
+
+    timeval timeout = {kClientTimeoutSeconds, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    if (ReadAll(fd, kMaxRequestSize, &request))
+      WriteAll(fd, server->HandleRequest(request, &stop));
+    close(fd);
+  }
+
+  close(listen_fd);
+  base::DeleteFile(socket_path, false);
+  return true;
+}
+
+}  // namespace
+
+int RunServer(const std::vector<std::string>& args) {
+  if (args.empty()) {
+    Err(Location(), "Need a build directory.",
+        "Usage: \"gn server <out_dir>\" or "
+        "\"gn server <out_dir> -- <command> [<args>...]\".")
+        .PrintToStdout();
+    return 1;
+  }
+
+  base::CommandLine* cmdline = base::CommandLine::ForCurrentProcess();
+  base::FilePath socket_path = GetSocketPath(args[0]);
+  if (socket_path.empty())
+    return 1;
+
+  if (args.size() > 1) {
+    return RunClient(socket_path,
+                     std::vector<std::string>(args.begin() + 1, args.end()));
+  }
+
+  // The output of the commands goes to the clients, which aren't consoles.
+  cmdline->AppendSwitch(switches::kNoColor);
+
+  Server* server = new Server(args[0], *cmdline);
+  if (!server->Load()) {
+    OutputString(server->load_output(), DECORATION_NONE, NO_ESCAPING);
+    return 1;
+  }
+
+  if (!cmdline->HasSwitch(switches::kQuiet)) {
+    OutputString("Serving " + args[0] + " on " + FilePathToUTF8(socket_path) +
+                 "\n");
+  }
+  fflush(stdout);
+
+  // Deliberately leaked to avoid expensive process teardown.
+  return Serve(server, socket_path) ? 0 : 1;
+}
+
+#endif  // !defined(OS_WIN)
+
+}  // namespace commands
@@ -0,0 +1,69 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_COMMAND_SERVER_H_
+#define TOOLS_GN_COMMAND_SERVER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "util/ticks.h"
+
+class Setup;
+
+namespace commands {
+
+// Keeps a build loaded for "gn server" and answers the requests of its
+// clients. The socket handling is in RunServer().
+class Server {
+ public:
+  Server(const std::string& build_dir, const base::CommandLine& cmdline);
+  ~Server();
+
+  // Loads the build. On failure, the error is in |load_output_|.
+  bool Load();
+
+  const std::string& load_output() const { return load_output_; }
+
+  // Runs a request and returns the reply. Sets |stop| for a stop request. See
+  // "gn help server" for the format of both.
+  std::string HandleRequest(const std::string& request, bool* stop);
+
+ private:
+  struct WatchedFile {
+    base::FilePath path;
+
+    // -1 if the file didn't exist.
+    int64_t size;
+    Ticks last_modified;
+  };
+
+  static WatchedFile StatFile(const base::FilePath& path);
+
+  // Remembers the current state of all files the build depends on.
+  void RecordWatchedFiles();
+  bool WatchedFilesChanged() const;
+
+  std::string build_dir_;
+  base::CommandLine cmdline_;
+
+  // The most recently loaded build. Replaced when files change.
+  std::unique_ptr<Setup> setup_;
+  bool loaded_;
+  std::string load_output_;
+
+  std::vector<WatchedFile> watched_files_;
+
+  DISALLOW_COPY_AND_ASSIGN(Server);
+};
+
+}  // namespace commands
+
+#endif  // TOOLS_GN_COMMAND_SERVER_H_
@@ -0,0 +1,137 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/command_server.h"
+
+#include <string>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "tools/gn/filesystem_utils.h"
+#include "tools/gn/switches.h"
+#include "util/msg_loop.h"
+#include "util/test/test.h"
+
+namespace {
+
+void WriteFile(const base::FilePath& path, const std::string& data) {
+  ASSERT_EQ(static_cast<int>(data.size()),
+            base::WriteFile(path, data.data(), static_cast<int>(data.size())));
+}
+
+// Joins |parts| into a request (see "gn help server").
+std::string MakeRequest(const std::vector<std::string>& parts) {
+  std::string request;
+  for (const std::string& part : parts) {
+    request.append(part);
+    request.push_back('\0');
+  }
+  return request;
+}
+
+class ServerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    root_ = temp_dir_.GetPath();
+    WriteFile(root_.AppendASCII(".gn"), "buildconfig = \"//BUILDCONFIG.gn\"\n");
+    WriteFile(root_.AppendASCII("BUILDCONFIG.gn"),
+              "set_default_toolchain(\"//build:tc\")\n");
+    ASSERT_TRUE(base::CreateDirectory(root_.AppendASCII("build")));
+    WriteFile(root_.AppendASCII("build").AppendASCII("BUILD.gn"),
+              "toolchain(\"tc\") {\n"
+              "  tool(\"stamp\") {\n"
+              "    command = \"touch {{output}}\"\n"
+              "  }\n"
+              "}\n");
+    WriteBuildFile("group(\"a\") {}\n");
+    ASSERT_TRUE(base::CreateDirectory(root_.AppendASCII("out")));
+    WriteFile(root_.AppendASCII("out").AppendASCII("build.ninja"), "");
+
+    base::CommandLine cmdline(base::CommandLine::NO_PROGRAM);
+    cmdline.AppendSwitchASCII(switches::kRoot, FilePathToUTF8(root_));
+    cmdline.AppendSwitch(switches::kQuiet);
+    server_.reset(new commands::Server(
+        FilePathToUTF8(root_.AppendASCII("out")), cmdline));
+  }
+
+  void WriteBuildFile(const std::string& contents) {
+    WriteFile(root_.AppendASCII("BUILD.gn"), contents);
+  }
+
+  // Sends a request from a client in the source root.
+  std::string Send(const std::vector<std::string>& command) {
+    std::vector<std::string> parts{FilePathToUTF8(root_)};
+    parts.insert(parts.end(), command.begin(), command.end());
+    bool stop = false;
+    std::string reply = server_->HandleRequest(MakeRequest(parts), &stop);
+    EXPECT_FALSE(stop);
+    return reply;
+  }
+
+  MsgLoop msg_loop_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath root_;
+  std::unique_ptr<commands::Server> server_;
+};
+
+}  // namespace
+
+TEST_F(ServerTest, InvalidRequests) {
+  bool stop = false;
+  EXPECT_EQ("1\nInvalid request.\n", server_->HandleRequest("", &stop));
+  EXPECT_EQ("1\nInvalid request.\n",
+            server_->HandleRequest(MakeRequest({"/"}), &stop));
+
+  // Every part must be terminated.
+  std::string unterminated = MakeRequest({"/", "ls"});
+  unterminated.pop_back();
+  EXPECT_EQ("1\nInvalid request.\n",
+            server_->HandleRequest(unterminated, &stop));
+  EXPECT_FALSE(stop);
+
+  EXPECT_EQ("0\n", server_->HandleRequest(MakeRequest({"/", "stop"}), &stop));
+  EXPECT_TRUE(stop);
+}
+
+TEST_F(ServerTest, RejectedRequests) {
+  ASSERT_TRUE(server_->Load()) << server_->load_output();
+
+  // Commands that write files or change the build aren't served.
+  EXPECT_EQ(
+      "1\nThe command \"gen\" can't be sent to gn server. See \"gn help "
+      "server\".\n",
+      Send({"gen"}));
+
+  // The server's stdin and stdout aren't the client's.
+  std::string reply = Send({"analyze", "--batch", "-", "-"});
+  EXPECT_EQ(0u, reply.find("1\n")) << reply;
+  EXPECT_NE(std::string::npos, reply.find("Can't use \"-\" in gn server."))
+      << reply;
+
+  // The client's directory must be absolute.
+  bool stop = false;
+  EXPECT_EQ("1\nThe directory relative doesn't exist.\n",
+            server_->HandleRequest(MakeRequest({"relative", "ls"}), &stop));
+}
+
+TEST_F(ServerTest, ReloadOnChange) {
+  ASSERT_TRUE(server_->Load()) << server_->load_output();
+
+  // Relative labels are resolved against the directory of the client.
+  EXPECT_EQ("0\n//:a\n", Send({"ls", ":a"}));
+  EXPECT_EQ("0\n//:a\n", Send({"ls"}));
+
+  WriteBuildFile("group(\"a\") {}\ngroup(\"b\") {}\n");
+  EXPECT_EQ("0\n//:a\n//:b\n", Send({"ls"}));
+
+  // A broken build file is reported until it's fixed.
+  WriteBuildFile("group(\"a\") {\n");
+  std::string reply = Send({"ls"});
+  EXPECT_EQ(0u, reply.find("1\n")) << reply;
+  WriteBuildFile("group(\"c\") {}\n");
+  EXPECT_EQ("0\n//:c\n", Send({"ls"}));
+}
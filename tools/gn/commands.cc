@@ -22,6 +22,12 @@ namespace commands {
 
 namespace {
 
+// Set while "gn server" answers a request. See SetPreloadedSetup().
+Setup* g_preloaded_setup = nullptr;
+
+// See SetCommandDirectory().
+base::FilePath* g_command_directory = nullptr;
+
 // Like above but the input string can be a pattern that matches multiple
 // targets. If the input does not parse as a pattern, prints and error and
 // returns false. If the pattern is valid, fills the vector (which might be
@@ -37,7 +43,7 @@ bool ResolveTargetsFromCommandLinePattern(Setup* setup,
 
   Err err;
   LabelPattern pattern = LabelPattern::GetPattern(
-      SourceDirForCurrentDirectory(setup->build_settings().root_path()),
+      SourceDirForCommandDirectory(setup->build_settings().root_path()),
       pattern_value, &err);
   if (err.has_error()) {
     err.PrintToStdout();
@@ -388,12 +394,49 @@ const CommandInfoMap& GetCommands() {
     INSERT_COMMAND(Ls)
     INSERT_COMMAND(Path)
     INSERT_COMMAND(Refs)
+    INSERT_COMMAND(Server)
 
 #undef INSERT_COMMAND
   }
   return info_map;
 }
 
+Setup* LoadBuildDir(const std::string& build_dir) {
+  if (g_preloaded_setup)
+    return g_preloaded_setup;
+
+  Setup* setup = new Setup;
+  if (!setup->DoSetup(build_dir, false) || !setup->Run())
+    return nullptr;
+  return setup;
+}
+
+void SetPreloadedSetup(Setup* setup) {
+  g_preloaded_setup = setup;
+}
+
+bool HasPreloadedSetup() {
+  return !!g_preloaded_setup;
+}
+
+void SetCommandDirectory(const base::FilePath& dir) {
+  delete g_command_directory;
+  g_command_directory = dir.empty() ? nullptr : new base::FilePath(dir);
+}
+
+base::FilePath CommandLinePathToFilePath(const std::string& path) {
+  base::FilePath file_path = UTF8ToFilePath(path);
+  if (!g_command_directory || file_path.IsAbsolute())
+    return file_path;
+  return g_command_directory->Append(file_path);
+}
+
+SourceDir SourceDirForCommandDirectory(const base::FilePath& source_root) {
+  if (!g_command_directory)
+    return SourceDirForCurrentDirectory(source_root);
+  return SourceDirForPath(source_root, *g_command_directory);
+}
+
 const Target* ResolveTargetFromCommandLineString(
     Setup* setup,
     const std::string& label_string) {
@@ -402,7 +445,7 @@ const Target* ResolveTargetFromCommandLineString(
   Value arg_value(nullptr, FixGitBashLabelEdit(label_string));
   Err err;
   Label label = Label::Resolve(
-      SourceDirForCurrentDirectory(setup->build_settings().root_path()),
+      SourceDirForCommandDirectory(setup->build_settings().root_path()),
       default_toolchain, arg_value, &err);
   if (err.has_error()) {
     err.PrintToStdout();
@@ -447,7 +490,7 @@ bool ResolveFromCommandLineInput(
   }
 
   SourceDir cur_dir =
-      SourceDirForCurrentDirectory(setup->build_settings().root_path());
+      SourceDirForCommandDirectory(setup->build_settings().root_path());
   for (const auto& cur : input) {
     if (!ResolveStringFromCommandLineInput(setup, cur_dir, cur, all_toolchains,
                                            target_matches, config_matches,
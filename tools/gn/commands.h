@@ -5,20 +5,27 @@
 #ifndef TOOLS_GN_COMMANDS_H_
 #define TOOLS_GN_COMMANDS_H_
 
+#include <stdio.h>
+
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "base/files/file_path.h"
 #include "base/strings/string_piece.h"
 #include "base/values.h"
 #include "tools/gn/target.h"
 #include "tools/gn/unique_vector.h"
 
+class Analyzer;
 class BuildSettings;
 class Config;
+class IncludeScanCache;
 class LabelPattern;
 class Setup;
+class SourceDir;
 class SourceFile;
 class Target;
 class Toolchain;
@@ -89,6 +96,11 @@ extern const char kRefs_HelpShort[];
 extern const char kRefs_Help[];
 int RunRefs(const std::vector<std::string>& args);
 
+extern const char kServer[];
+extern const char kServer_HelpShort[];
+extern const char kServer_Help[];
+int RunServer(const std::vector<std::string>& args);
+
 // -----------------------------------------------------------------------------
 
 struct CommandInfo {
@@ -108,6 +120,44 @@ const CommandInfoMap& GetCommands();
 
 // Helper functions for some commands ------------------------------------------
 
+// Loads and runs the build files for the given existing build directory. On
+// failure, prints the error and returns null. The Setup is deliberately leaked
+// to avoid expensive process teardown.
+//
+// Inside "gn server", this returns the server's already loaded Setup instead
+// and |build_dir| is ignored (see SetPreloadedSetup()).
+Setup* LoadBuildDir(const std::string& build_dir);
+
+// Makes LoadBuildDir() return |setup|, or restores the normal behavior when
+// null. The setup must already have been run.
+void SetPreloadedSetup(Setup* setup);
+
+// Returns true when a Setup was given to SetPreloadedSetup(), meaning the
+// command runs inside "gn server" and must not use the process's stdin or
+// stdout directly.
+bool HasPreloadedSetup();
+
+// Makes the relative paths and labels given to commands resolve against |dir|
+// instead of the current directory, or restores the normal behavior when
+// |dir| is empty. "gn server" uses this for the directory of each client.
+void SetCommandDirectory(const base::FilePath& dir);
+
+// Converts a path given on the command line to a file path, resolving it
+// against the directory set by SetCommandDirectory() if it's relative.
+base::FilePath CommandLinePathToFilePath(const std::string& path);
+
+// Returns the source directory that relative labels given on the command line
+// are resolved against (see SetCommandDirectory()).
+SourceDir SourceDirForCommandDirectory(const base::FilePath& source_root);
+
+// Answers each line of |input| with |analyzer| and writes the results to
+// |output|, one line each, for "gn analyze --batch". |output_name| is used in
+// error messages. Returns the exit code for the command.
+int AnalyzeBatch(const Analyzer& analyzer,
+                 FILE* input,
+                 FILE* output,
+                 const std::string& output_name);
+
 // Given a setup that has already been run and some command-line input,
 // resolves that input as a target label and returns the corresponding target.
 // On failure, returns null and prints the error to the standard output.
@@ -130,6 +180,11 @@ bool ResolveFromCommandLineInput(
     UniqueVector<const Toolchain*>* toolchain_matches,
     UniqueVector<SourceFile>* file_matches);
 
+// Returns the cache of scanned includes for the given build directory. It must
+// be loaded before use.
+std::unique_ptr<IncludeScanCache> MakeIncludeScanCache(
+    const BuildSettings* build_settings);
+
 // Runs the header checker. All targets in the build should be given in
 // all_targets, and the specific targets to check should be in to_check.
 //
@@ -140,12 +195,17 @@ bool ResolveFromCommandLineInput(
 // unless a build has been run, but passing true for |check_generated|
 // will attempt to check them anyway, assuming they exist.
 //
+// The includes found in the files are cached in the build directory. If
+// |include_scan_cache| is non-null, it is used instead of loading the cache
+// file here, and the caller must save it.
+//
 // On success, returns true. If the check fails, the error(s) will be printed
 // to stdout and false will be returned.
 bool CheckPublicHeaders(const BuildSettings* build_settings,
                         const std::vector<const Target*>& all_targets,
                         const std::vector<const Target*>& to_check,
-                        bool force_check, bool check_generated);
+                        bool force_check, bool check_generated,
+                        IncludeScanCache* include_scan_cache);
 
 // Filters the given list of targets by the given pattern list.
 void FilterTargetsByPatterns(const std::vector<const Target*>& input,
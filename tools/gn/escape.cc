@@ -181,11 +181,58 @@ void EscapeStringToString(const base::StringPiece& str,
   }
 }
 
+// Returns true if EscapeStringToString() would change |str|. Most paths need
+// no escaping at all, and this check is a lot cheaper than building an escaped
+// copy, so it lets them be written out directly.
+bool NeedsEscaping(const base::StringPiece& str, const EscapeOptions& options) {
+  EscapingPlatform platform = options.platform;
+  switch (options.mode) {
+    case ESCAPE_NONE:
+      return false;
+    case ESCAPE_NINJA:
+      for (char ch : str) {
+        if (ch == '$' || ch == ' ' || ch == ':')
+          return true;
+      }
+      return false;
+    case ESCAPE_NINJA_COMMAND:
+      if (platform == ESCAPE_PLATFORM_CURRENT) {
+#if defined(OS_WIN)
+        platform = ESCAPE_PLATFORM_WIN;
+#else
+        platform = ESCAPE_PLATFORM_POSIX;
+#endif
+      }
+      if (platform == ESCAPE_PLATFORM_WIN) {
+        // Without spaces or quotes, this is only Ninja escaping.
+        for (char ch : str) {
+          if (ch == '$' || ch == ' ' || ch == ':' || ch == '"')
+            return true;
+        }
+        return false;
+      }
+      for (char ch : str) {
+        if (ch == ':' || static_cast<unsigned char>(ch) >= 0x80 ||
+            !kShellValid[static_cast<int>(ch)])
+          return true;
+      }
+      return false;
+    case ESCAPE_NINJA_PREFORMATTED_COMMAND:
+      return str.find('$') != base::StringPiece::npos;
+    default:
+      NOTREACHED();
+      return true;
+  }
+}
+
 }  // namespace
 
 std::string EscapeString(const base::StringPiece& str,
                          const EscapeOptions& options,
                          bool* needed_quoting) {
+  if (!NeedsEscaping(str, options))
+    return str.as_string();
+
   std::string result;
   result.reserve(str.size() + 4);  // Guess we'll add a couple of extra chars.
   EscapeStringToString(str, options, &result, needed_quoting);
@@ -195,8 +242,15 @@ std::string EscapeString(const base::StringPiece& str,
 void EscapeStringToStream(std::ostream& out,
                           const base::StringPiece& str,
                           const EscapeOptions& options) {
+  if (!NeedsEscaping(str, options)) {
+    // The common case, write the input without copying it.
+    if (!str.empty())
+      out.write(str.data(), str.size());
+    return;
+  }
+
   std::string escaped;
+  escaped.reserve(str.size() + 4);
   EscapeStringToString(str, options, &escaped, nullptr);
-  if (!escaped.empty())
-    out.write(escaped.data(), escaped.size());
+  out.write(escaped.data(), escaped.size());
 }
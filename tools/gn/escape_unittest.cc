@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <sstream>
+
 #include "tools/gn/escape.h"
 #include "util/test/test.h"
 
@@ -62,3 +64,36 @@ TEST(Escape, NinjaPreformatted) {
   // Only $ is escaped.
   EXPECT_EQ("a: \"$$\\b<;", EscapeString("a: \"$\\b<;", opts, nullptr));
 }
+
+TEST(Escape, NothingToEscape) {
+  const char kPath[] = "obj/base/libbase.a";
+  const EscapingMode kModes[] = {ESCAPE_NONE, ESCAPE_NINJA,
+                                 ESCAPE_NINJA_COMMAND,
+                                 ESCAPE_NINJA_PREFORMATTED_COMMAND};
+  const EscapingPlatform kPlatforms[] = {ESCAPE_PLATFORM_WIN,
+                                         ESCAPE_PLATFORM_POSIX};
+  for (EscapingMode mode : kModes) {
+    for (EscapingPlatform platform : kPlatforms) {
+      EscapeOptions opts;
+      opts.mode = mode;
+      opts.platform = platform;
+      bool needs_quoting = false;
+      EXPECT_EQ(kPath, EscapeString(kPath, opts, &needs_quoting));
+      EXPECT_FALSE(needs_quoting);
+
+      std::ostringstream out;
+      EscapeStringToStream(out, kPath, opts);
+      EscapeStringToStream(out, "", opts);
+      EXPECT_EQ(kPath, out.str());
+    }
+  }
+
+  // A single special character anywhere still gets escaped by the stream
+  // version.
+  EscapeOptions opts;
+  opts.mode = ESCAPE_NINJA_COMMAND;
+  opts.platform = ESCAPE_PLATFORM_POSIX;
+  std::ostringstream out;
+  EscapeStringToStream(out, "obj/a b.o", opts);
+  EXPECT_EQ("obj/a\\$ b.o", out.str());
+}
@@ -21,12 +21,23 @@
 #else
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
 #include <sys/signal.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include "base/posix/eintr_wrapper.h"
 #include "base/posix/file_descriptor_shuffle.h"
+
+// posix_spawn_file_actions_addchdir_np() sets the child's working directory
+// without fork(). Elsewhere processes are started with fork() and exec().
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+#define GN_HAS_SPAWN_CHDIR
+#endif
+
+extern char** environ;
 #endif
 
 namespace internal {
@@ -137,24 +148,36 @@ bool ExecProcess(const base::string16& cmdline_str,
   return true;
 }
 #else
-// Reads from the provided file descriptor and appends to output. Returns false
-// if the fd is closed or there is an unexpected error (not
-// EINTR/EAGAIN/EWOULDBLOCK).
-bool ReadFromPipe(int fd, std::string* output) {
-  char buffer[256];
-  int bytes_read = HANDLE_EINTR(read(fd, buffer, sizeof(buffer)));
-  if (bytes_read == -1) {
-    return errno == EAGAIN || errno == EWOULDBLOCK;
-  } else if (bytes_read <= 0) {
+// Creates a pipe whose ends are closed in child processes, so that processes
+// started concurrently from other threads don't keep each other's pipes open.
+bool CreateChildPipe(int fds[2]) {
+#if defined(OS_LINUX)
+  return pipe2(fds, O_CLOEXEC) == 0;
+#else
+  if (pipe(fds) < 0)
     return false;
-  }
+  return base::SetCloseOnExec(fds[0]) && base::SetCloseOnExec(fds[1]);
+#endif
+}
+
+// Size of the buffer ReadFromPipe() reads into, the default capacity of a
+// pipe on Linux.
+const size_t kReadBufferSize = 64 * 1024;
+
+// Reads from the provided file descriptor into |buffer| (of |kReadBufferSize|
+// bytes) and appends to output. Returns false if the fd is closed or there is
+// an unexpected error (not EINTR/EAGAIN/EWOULDBLOCK).
+bool ReadFromPipe(int fd, char* buffer, std::string* output) {
+  ssize_t bytes_read = HANDLE_EINTR(read(fd, buffer, kReadBufferSize));
+  if (bytes_read == -1)
+    return errno == EAGAIN || errno == EWOULDBLOCK;
   output->append(buffer, bytes_read);
-  return true;
+  return bytes_read > 0;
 }
 
 bool WaitForExit(int pid, int* exit_code) {
   int status;
-  if (waitpid(pid, &status, 0) < 0) {
+  if (HANDLE_EINTR(waitpid(pid, &status, 0)) < 0) {
     PLOG(ERROR) << "waitpid";
     return false;
   }
@@ -170,6 +193,93 @@ bool WaitForExit(int pid, int* exit_code) {
   return false;
 }
 
+// Returned by StartProcess() when the process was started but couldn't run
+// the program, which is reported like the exit code 127 of a child whose
+// exec() failed.
+const pid_t kExecFailed = 0;
+
+#if defined(GN_HAS_SPAWN_CHDIR)
+// Starts the process with posix_spawn(), which doesn't copy the page tables
+// of this (potentially very large) process the way fork() does. Returns the
+// pid, kExecFailed if the program couldn't be run, or -1 if the process
+// couldn't be started.
+pid_t StartProcess(char* const argv[],
+                   const base::FilePath& startup_dir,
+                   int out_write,
+                   int err_write) {
+  posix_spawn_file_actions_t actions;
+  if (posix_spawn_file_actions_init(&actions) != 0)
+    return -1;
+  pid_t pid = -1;
+  if (posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null",
+                                       O_RDONLY, 0) == 0 &&
+      posix_spawn_file_actions_adddup2(&actions, out_write, STDOUT_FILENO) ==
+          0 &&
+      posix_spawn_file_actions_adddup2(&actions, err_write, STDERR_FILENO) ==
+          0 &&
+      posix_spawn_file_actions_addchdir_np(&actions,
+                                           startup_dir.value().c_str()) == 0) {
+    int error = posix_spawnp(&pid, argv[0], &actions, nullptr, argv, environ);
+    if (error == EAGAIN || error == ENOMEM)
+      pid = -1;
+    else if (error != 0)
+      pid = kExecFailed;  // Missing program, failed chdir, etc.
+  }
+  posix_spawn_file_actions_destroy(&actions);
+  return pid;
+}
+#else
+// Starts the process with fork() and exec(), for systems where posix_spawn()
+// can't set the working directory. Returns the pid, or -1 if the process
+// couldn't be started.
+pid_t StartProcess(char* const argv[],
+                   const base::FilePath& startup_dir,
+                   int out_write,
+                   int err_write) {
+  base::InjectiveMultimap fd_shuffle1, fd_shuffle2;
+  fd_shuffle1.reserve(3);
+  fd_shuffle2.reserve(3);
+
+  pid_t pid = fork();
+  if (pid != 0)
+    return pid;  // Parent, or error.
+
+  // DANGER: no calls to malloc are allowed from now on:
+  // http://crbug.com/36678
+  //
+  // STL iterators are also not allowed (including those implied
+  // by range-based for loops), since debug iterators use locks.
+
+  // Obscure fork() rule: in the child, if you don't end up doing exec*(),
+  // you call _exit() instead of exit(). This is because _exit() does not
+  // call any previously-registered (in the parent) exit handlers, which
+  // might do things like block waiting for threads that don't even exist
+  // in the child.
+  int dev_null = open("/dev/null", O_RDONLY);
+  if (dev_null < 0)
+    _exit(127);
+
+  fd_shuffle1.push_back(base::InjectionArc(out_write, STDOUT_FILENO, true));
+  fd_shuffle1.push_back(base::InjectionArc(err_write, STDERR_FILENO, true));
+  fd_shuffle1.push_back(base::InjectionArc(dev_null, STDIN_FILENO, true));
+  // Adding another element here? Remeber to increase the argument to
+  // reserve(), above.
+
+  // DANGER: Do NOT convert to range-based for loop!
+  for (size_t i = 0; i < fd_shuffle1.size(); ++i)
+    fd_shuffle2.push_back(fd_shuffle1[i]);
+
+  if (!ShuffleFileDescriptors(&fd_shuffle1))
+    _exit(127);
+
+  if (chdir(startup_dir.value().c_str()) < 0)
+    _exit(127);
+
+  execvp(argv[0], argv);
+  _exit(127);
+}
+#endif
+
 bool ExecProcess(const base::CommandLine& cmdline,
                  const base::FilePath& startup_dir,
                  std::string* std_out,
@@ -177,104 +287,64 @@ bool ExecProcess(const base::CommandLine& cmdline,
                  int* exit_code) {
   *exit_code = EXIT_FAILURE;
 
-  std::vector<std::string> argv = cmdline.argv();
-
-  int out_fd[2], err_fd[2];
-  pid_t pid;
-  base::InjectiveMultimap fd_shuffle1, fd_shuffle2;
+  const std::vector<std::string>& argv = cmdline.argv();
   std::unique_ptr<char*[]> argv_cstr(new char*[argv.size() + 1]);
+  for (size_t i = 0; i < argv.size(); i++)
+    argv_cstr[i] = const_cast<char*>(argv[i].c_str());
+  argv_cstr[argv.size()] = nullptr;
 
-  fd_shuffle1.reserve(3);
-  fd_shuffle2.reserve(3);
-
-  if (pipe(out_fd) < 0)
+  int out_fd[2], err_fd[2];
+  if (!CreateChildPipe(out_fd))
     return false;
   base::ScopedFD out_read(out_fd[0]), out_write(out_fd[1]);
 
-  if (pipe(err_fd) < 0)
+  if (!CreateChildPipe(err_fd))
     return false;
   base::ScopedFD err_read(err_fd[0]), err_write(err_fd[1]);
 
-  if (out_read.get() >= FD_SETSIZE || err_read.get() >= FD_SETSIZE)
+  pid_t pid = StartProcess(argv_cstr.get(), startup_dir, out_write.get(),
+                           err_write.get());
+  if (pid < 0)
     return false;
+  if (pid == kExecFailed) {
+    *exit_code = 127;
+    return true;
+  }
 
-  switch (pid = fork()) {
-    case -1:  // error
-      return false;
-    case 0:  // child
-    {
-      // DANGER: no calls to malloc are allowed from now on:
-      // http://crbug.com/36678
-      //
-      // STL iterators are also not allowed (including those implied
-      // by range-based for loops), since debug iterators use locks.
-
-      // Obscure fork() rule: in the child, if you don't end up doing exec*(),
-      // you call _exit() instead of exit(). This is because _exit() does not
-      // call any previously-registered (in the parent) exit handlers, which
-      // might do things like block waiting for threads that don't even exist
-      // in the child.
-      int dev_null = open("/dev/null", O_WRONLY);
-      if (dev_null < 0)
-        _exit(127);
-
-      fd_shuffle1.push_back(
-          base::InjectionArc(out_write.get(), STDOUT_FILENO, true));
-      fd_shuffle1.push_back(
-          base::InjectionArc(err_write.get(), STDERR_FILENO, true));
-      fd_shuffle1.push_back(base::InjectionArc(dev_null, STDIN_FILENO, true));
-      // Adding another element here? Remeber to increase the argument to
-      // reserve(), above.
-
-      // DANGER: Do NOT convert to range-based for loop!
-      for (size_t i = 0; i < fd_shuffle1.size(); ++i)
-        fd_shuffle2.push_back(fd_shuffle1[i]);
-
-      if (!ShuffleFileDescriptors(&fd_shuffle1))
-        _exit(127);
-
-      base::SetCurrentDirectory(startup_dir);
-
-      // TODO(brettw) the base version GetAppOutput does a
-      // CloseSuperfluousFds call here. Do we need this?
-
-      // DANGER: Do NOT convert to range-based for loop!
-      for (size_t i = 0; i < argv.size(); i++)
-        argv_cstr[i] = const_cast<char*>(argv[i].c_str());
-      argv_cstr[argv.size()] = nullptr;
-      execvp(argv_cstr[0], argv_cstr.get());
-      _exit(127);
+  // Close our writing end of pipe now. Otherwise later read would not
+  // be able to detect end of child's output (in theory we could still
+  // write to the pipe).
+  out_write.reset();
+  err_write.reset();
+
+  // poll() rather than select(), which can't handle descriptors above
+  // FD_SETSIZE in a process that has many files open.
+  struct pollfd fds[2];
+  fds[0].fd = out_read.get();
+  fds[1].fd = err_read.get();
+  std::string* outputs[2] = {std_out, std_err};
+  std::unique_ptr<char[]> buffer(new char[kReadBufferSize]);
+  int open_count = 2;
+  while (open_count > 0) {
+    for (struct pollfd& fd : fds) {
+      fd.events = POLLIN;
+      fd.revents = 0;
     }
-    default:  // parent
-    {
-      // Close our writing end of pipe now. Otherwise later read would not
-      // be able to detect end of child's output (in theory we could still
-      // write to the pipe).
-      out_write.reset();
-      err_write.reset();
-
-      bool out_open = true, err_open = true;
-      while (out_open || err_open) {
-        fd_set read_fds;
-        FD_ZERO(&read_fds);
-        FD_SET(out_read.get(), &read_fds);
-        FD_SET(err_read.get(), &read_fds);
-        int res =
-            HANDLE_EINTR(select(std::max(out_read.get(), err_read.get()) + 1,
-                                &read_fds, nullptr, nullptr, nullptr));
-        if (res <= 0)
-          break;
-        if (FD_ISSET(out_read.get(), &read_fds))
-          out_open = ReadFromPipe(out_read.get(), std_out);
-        if (FD_ISSET(err_read.get(), &read_fds))
-          err_open = ReadFromPipe(err_read.get(), std_err);
+    int res = HANDLE_EINTR(poll(fds, 2, -1));
+    if (res <= 0)
+      break;
+    for (int i = 0; i < 2; i++) {
+      if (fds[i].fd < 0 || !fds[i].revents)
+        continue;
+      // POLLHUP without POLLIN still reads the end of the output.
+      if (!ReadFromPipe(fds[i].fd, buffer.get(), outputs[i])) {
+        fds[i].fd = -1;  // Ignored by poll() from now on.
+        open_count--;
       }
-
-      return WaitForExit(pid, exit_code);
     }
   }
 
-  return false;
+  return WaitForExit(pid, exit_code);
 }
 #endif
 
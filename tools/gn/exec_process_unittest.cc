@@ -5,6 +5,7 @@
 #include "tools/gn/exec_process.h"
 
 #include "base/command_line.h"
+#include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/strings/string_util.h"
 #include "util/build_config.h"
@@ -121,5 +122,38 @@ TEST(ExecProcessTest, TestOneOutputClosed) {
   EXPECT_EQ(0u, std_out.size());
   EXPECT_EQ(10001u, std_err.size());
 }
+
+TEST(ExecProcessTest, TestStartupDir) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath startup_dir = base::MakeAbsoluteFilePath(temp_dir.GetPath());
+  ASSERT_FALSE(startup_dir.empty());
+
+  base::CommandLine::StringVector args;
+  args.push_back("python");
+  args.push_back("-c");
+  args.push_back("import os, sys; sys.stdout.write(os.getcwd())");
+  std::string std_out, std_err;
+  int exit_code;
+  ASSERT_TRUE(ExecProcess(base::CommandLine(args), startup_dir, &std_out,
+                          &std_err, &exit_code));
+  EXPECT_EQ(0, exit_code);
+  EXPECT_EQ(startup_dir.value(), std_out);
+}
+
+// A program that can't be run exits with 127, like in a shell.
+TEST(ExecProcessTest, TestMissingProgram) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  base::CommandLine::StringVector args;
+  args.push_back(temp_dir.GetPath().AppendASCII("missing").value());
+  std::string std_out, std_err;
+  int exit_code;
+  ASSERT_TRUE(ExecProcess(base::CommandLine(args), temp_dir.GetPath(),
+                          &std_out, &std_err, &exit_code));
+  EXPECT_EQ(127, exit_code);
+  EXPECT_EQ("", std_out);
+}
 #endif
 }  // namespace internal
@@ -0,0 +1,229 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/exec_script_cache.h"
+
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "tools/gn/filesystem_utils.h"
+
+namespace {
+
+const char kExecScriptCacheMagic[] = "GNES";
+
+// Increment when the entry layout changes.
+const uint32_t kExecScriptCacheVersion = 1;
+
+}  // namespace
+
+ExecScriptCache::Result::Result() : executed(false), exit_code(0) {}
+
+ExecScriptCache::Result::~Result() = default;
+
+ExecScriptCache::Entry::Entry() : done(false) {}
+
+ExecScriptCache::Entry::~Entry() = default;
+
+ExecScriptCache::FileEntry::FileEntry() : used(false) {}
+
+ExecScriptCache::FileEntry::FileEntry(FileEntry&&) = default;
+
+ExecScriptCache::FileEntry::~FileEntry() = default;
+
+ExecScriptCache::FileEntry& ExecScriptCache::FileEntry::operator=(
+    FileEntry&&) = default;
+
+ExecScriptCache::ExecScriptCache() : dirty_(false), hit_count_(0) {}
+
+ExecScriptCache::~ExecScriptCache() = default;
+
+void ExecScriptCache::EnableFileCache(const base::FilePath& cache_file) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    cache_file_ = cache_file;
+  }
+
+  std::string body;
+  if (!ReadCacheFile(cache_file, kExecScriptCacheMagic,
+                     kExecScriptCacheVersion, &body))
+    return;
+
+  std::map<std::string, FileEntry> file_entries;
+  CacheReader reader(body);
+  uint64_t count;
+  if (!reader.ReadVarint(&count))
+    return;
+  for (uint64_t i = 0; i < count; i++) {
+    base::StringPiece key;
+    base::StringPiece output;
+    uint64_t dependency_count;
+    if (!reader.ReadString(&key) || !reader.ReadString(&output) ||
+        !reader.ReadVarint(&dependency_count))
+      return;  // Corrupt, ignore the whole file.
+
+    FileEntry entry;
+    entry.output = output.as_string();
+    for (uint64_t j = 0; j < dependency_count; j++) {
+      base::StringPiece name;
+      FileStamp stamp;
+      if (!reader.ReadString(&name) || !stamp.Read(&reader))
+        return;
+      entry.dependencies.emplace_back(name.as_string(), stamp);
+    }
+    file_entries[key.as_string()] = std::move(entry);
+  }
+  if (!reader.at_end())
+    return;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  file_entries_ = std::move(file_entries);
+}
+
+bool ExecScriptCache::SaveFileCache() {
+  CacheWriter writer;
+  base::FilePath cache_file;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (cache_file_.empty())
+      return true;
+    cache_file = cache_file_;
+
+    size_t used_count = 0;
+    for (const auto& pair : file_entries_) {
+      if (pair.second.used)
+        used_count++;
+    }
+    if (!dirty_ && used_count == file_entries_.size())
+      return true;  // Nothing changed.
+
+    writer.WriteVarint(used_count);
+    for (const auto& pair : file_entries_) {
+      if (!pair.second.used)
+        continue;
+      writer.WriteString(pair.first);
+      writer.WriteString(pair.second.output);
+      writer.WriteVarint(pair.second.dependencies.size());
+      for (const auto& dependency : pair.second.dependencies) {
+        writer.WriteString(dependency.first);
+        dependency.second.Write(&writer);
+      }
+    }
+  }
+  return WriteCacheFile(cache_file, kExecScriptCacheMagic,
+                        kExecScriptCacheVersion, writer);
+}
+
+ExecScriptCache::Result ExecScriptCache::Run(
+    const std::string& key,
+    const std::vector<base::FilePath>& dependencies,
+    const Runner& runner) {
+  Entry* entry;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    std::unique_ptr<Entry>& found = entries_[key];
+    if (!found)
+      found.reset(new Entry);
+    entry = found.get();
+  }
+
+  // Concurrent calls for the same command wait here for the first one.
+  std::lock_guard<std::mutex> entry_lock(entry->lock);
+  if (entry->done) {
+    std::lock_guard<std::mutex> lock(lock_);
+    hit_count_++;
+    return entry->result;
+  }
+
+  std::string output;
+  if (LookupFile(key, dependencies, &output)) {
+    entry->result.executed = true;
+    entry->result.output = std::move(output);
+  } else {
+    runner.Run(&entry->result);
+    if (entry->result.executed && entry->result.exit_code == 0)
+      AddToFile(key, dependencies, entry->result.output);
+  }
+  entry->done = true;
+  return entry->result;
+}
+
+int ExecScriptCache::hit_count() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return hit_count_;
+}
+
+// static
+bool ExecScriptCache::IsFileEntryValid(
+    const FileEntry& entry,
+    const std::vector<base::FilePath>& dependencies) {
+  if (entry.dependencies.size() != dependencies.size())
+    return false;
+  for (size_t i = 0; i < dependencies.size(); i++) {
+    const FileStamp& cached = entry.dependencies[i].second;
+    if (entry.dependencies[i].first != FilePathToUTF8(dependencies[i]))
+      return false;
+
+    base::File::Info info;
+    if (!base::GetFileInfo(dependencies[i], &info) ||
+        info.size != cached.size)
+      return false;
+    if (info.last_modified != cached.last_modified) {
+      // Touched, but maybe not changed.
+      FileStamp stamp;
+      if (!GetFileStamp(dependencies[i], &stamp) || !stamp.SameContents(cached))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool ExecScriptCache::LookupFile(
+    const std::string& key,
+    const std::vector<base::FilePath>& dependencies,
+    std::string* output) {
+  FileEntry* entry;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = file_entries_.find(key);
+    if (found == file_entries_.end())
+      return false;
+    entry = &found->second;
+  }
+
+  // The entry for this key is only used by the thread running its command,
+  // so it can be read without the lock.
+  if (!IsFileEntryValid(*entry, dependencies))
+    return false;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entry->used = true;
+  *output = entry->output;
+  hit_count_++;
+  return true;
+}
+
+void ExecScriptCache::AddToFile(
+    const std::string& key,
+    const std::vector<base::FilePath>& dependencies,
+    const std::string& output) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (cache_file_.empty())
+      return;
+  }
+
+  FileEntry entry;
+  for (const base::FilePath& dependency : dependencies) {
+    FileStamp stamp;
+    if (!GetFileStamp(dependency, &stamp))
+      return;  // Can't tell when it changes, so don't keep it.
+    entry.dependencies.emplace_back(FilePathToUTF8(dependency), stamp);
+  }
+  entry.output = output;
+  entry.used = true;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  file_entries_[key] = std::move(entry);
+  dirty_ = true;
+}
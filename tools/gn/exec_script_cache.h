@@ -0,0 +1,122 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_EXEC_SCRIPT_CACHE_H_
+#define TOOLS_GN_EXEC_SCRIPT_CACHE_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "tools/gn/cache_file.h"
+
+// Remembers the results of the processes run by exec_script(), so running the
+// same command again doesn't start another process.
+//
+// Within a run, every command is run once: later calls with the same key get
+// the first result, and concurrent calls wait for it.
+//
+// With EnableFileCache(), successful results are also kept in a file in the
+// build directory for later runs. Such an entry is reused as long as the
+// contents of all its dependencies (the script and its file_dependencies) are
+// unchanged, so it is only correct for scripts whose output depends on
+// nothing else.
+//
+// This class is threadsafe.
+class ExecScriptCache {
+ public:
+  struct Result {
+    Result();
+    ~Result();
+
+    bool executed;  // False if the process couldn't be started.
+    std::string output;
+    std::string stderr_output;
+    int exit_code;
+  };
+
+  // Runs the command and fills in the result.
+  typedef base::Callback<void(Result*)> Runner;
+
+  ExecScriptCache();
+  ~ExecScriptCache();
+
+  // Reads the cache file, and keeps successful results in it from now on.
+  void EnableFileCache(const base::FilePath& cache_file);
+
+  // Writes the results used during this run to the cache file, if it's
+  // enabled and anything changed. Entries that weren't used are dropped.
+  bool SaveFileCache();
+
+  // Returns the result of the command identified by |key|, which must
+  // contain everything that affects the output (command line, working
+  // directory). |runner| is only called when there is no result for it yet.
+  // |dependencies| are only used by the file cache.
+  Result Run(const std::string& key,
+             const std::vector<base::FilePath>& dependencies,
+             const Runner& runner);
+
+  // Number of calls answered without running the command.
+  int hit_count() const;
+
+ private:
+  // The result of one command during this run.
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    std::mutex lock;  // Held while the command runs.
+    bool done;
+    Result result;
+  };
+
+  // A successful result kept in the cache file.
+  struct FileEntry {
+    FileEntry();
+    FileEntry(FileEntry&&);
+    ~FileEntry();
+    FileEntry& operator=(FileEntry&&);
+
+    std::vector<std::pair<std::string, FileStamp>> dependencies;
+    std::string output;
+    bool used;
+  };
+
+  // Returns true if the file entry can be used for the given dependencies.
+  static bool IsFileEntryValid(const FileEntry& entry,
+                               const std::vector<base::FilePath>& dependencies);
+
+  // Returns the cached output for |key| from the cache file, if valid.
+  bool LookupFile(const std::string& key,
+                  const std::vector<base::FilePath>& dependencies,
+                  std::string* output);
+
+  // Adds a successful result to the cache file.
+  void AddToFile(const std::string& key,
+                 const std::vector<base::FilePath>& dependencies,
+                 const std::string& output);
+
+  mutable std::mutex lock_;
+
+  std::map<std::string, std::unique_ptr<Entry>> entries_;
+
+  // Empty unless the file cache is enabled.
+  base::FilePath cache_file_;
+  std::map<std::string, FileEntry> file_entries_;
+
+  // Set when a file entry was added or updated.
+  bool dirty_;
+
+  int hit_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ExecScriptCache);
+};
+
+#endif  // TOOLS_GN_EXEC_SCRIPT_CACHE_H_
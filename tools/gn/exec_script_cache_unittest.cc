@@ -0,0 +1,96 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "tools/gn/exec_script_cache.h"
+#include "util/test/test.h"
+
+namespace {
+
+void WriteScript(const base::FilePath& path, const std::string& contents) {
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(path, contents.c_str(),
+                            static_cast<int>(contents.size())));
+}
+
+// Runner that counts how often it was called.
+void CountingRunner(int* run_count,
+                    int exit_code,
+                    ExecScriptCache::Result* result) {
+  (*run_count)++;
+  result->executed = true;
+  result->exit_code = exit_code;
+  result->output = "run " + std::to_string(*run_count);
+}
+
+}  // namespace
+
+TEST(ExecScriptCache, RunsOncePerKey) {
+  ExecScriptCache cache;
+  std::vector<base::FilePath> dependencies;
+  int run_count = 0;
+  ExecScriptCache::Runner runner = base::Bind(&CountingRunner, &run_count, 0);
+
+  EXPECT_EQ("run 1", cache.Run("a", dependencies, runner).output);
+  EXPECT_EQ("run 1", cache.Run("a", dependencies, runner).output);
+  EXPECT_EQ("run 2", cache.Run("b", dependencies, runner).output);
+  EXPECT_EQ(2, run_count);
+  EXPECT_EQ(1, cache.hit_count());
+
+  // Failures are remembered too, so the error is reported the same way.
+  ExecScriptCache::Runner failing = base::Bind(&CountingRunner, &run_count, 1);
+  EXPECT_EQ(1, cache.Run("c", dependencies, failing).exit_code);
+  EXPECT_EQ(1, cache.Run("c", dependencies, failing).exit_code);
+  EXPECT_EQ(3, run_count);
+}
+
+TEST(ExecScriptCache, FileCache) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath cache_file = temp_dir.GetPath().AppendASCII("gn.cache");
+  base::FilePath script = temp_dir.GetPath().AppendASCII("script.py");
+  WriteScript(script, "print 1\n");
+  std::vector<base::FilePath> dependencies{script};
+
+  int run_count = 0;
+  ExecScriptCache::Runner runner = base::Bind(&CountingRunner, &run_count, 0);
+  ExecScriptCache::Runner failing = base::Bind(&CountingRunner, &run_count, 1);
+  {
+    ExecScriptCache cache;
+    cache.EnableFileCache(cache_file);
+    EXPECT_EQ("run 1", cache.Run("a", dependencies, runner).output);
+    EXPECT_EQ(1, cache.Run("b", dependencies, failing).exit_code);
+    EXPECT_TRUE(cache.SaveFileCache());
+  }
+  EXPECT_EQ(2, run_count);
+
+  // A later run reuses the successful result only.
+  {
+    ExecScriptCache cache;
+    cache.EnableFileCache(cache_file);
+    ExecScriptCache::Result result = cache.Run("a", dependencies, runner);
+    EXPECT_TRUE(result.executed);
+    EXPECT_EQ(0, result.exit_code);
+    EXPECT_EQ("run 1", result.output);
+    EXPECT_EQ(1, cache.Run("b", dependencies, failing).exit_code);
+    EXPECT_EQ(1, cache.hit_count());
+    EXPECT_TRUE(cache.SaveFileCache());
+  }
+  EXPECT_EQ(3, run_count);
+
+  // Changing a dependency invalidates the entry.
+  WriteScript(script, "print 2\n");
+  {
+    ExecScriptCache cache;
+    cache.EnableFileCache(cache_file);
+    EXPECT_EQ("run 4", cache.Run("a", dependencies, runner).output);
+    EXPECT_EQ(0, cache.hit_count());
+  }
+  EXPECT_EQ(4, run_count);
+}
@@ -4,8 +4,12 @@
 
 #include "tools/gn/filesystem_utils.h"
 
+#include <string.h>
+
 #include <algorithm>
+#include <memory>
 
+#include "base/files/file.h"
 #include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/strings/string_util.h"
@@ -13,6 +17,7 @@
 #include "tools/gn/location.h"
 #include "tools/gn/settings.h"
 #include "tools/gn/source_dir.h"
+#include "tools/gn/trace.h"
 #include "util/build_config.h"
 
 #if defined(OS_WIN)
@@ -889,20 +894,32 @@ std::string GetOutputSubdirName(const Label& toolchain_label, bool is_default) {
 }
 
 bool ContentsEqual(const base::FilePath& file_path, const std::string& data) {
-  // Compare file and stream sizes first. Quick and will save us some time if
-  // they are different sizes.
-  int64_t file_size;
-  if (!base::GetFileSize(file_path, &file_size) ||
-      static_cast<size_t>(file_size) != data.size()) {
+  base::File file(file_path, base::File::FLAG_OPEN | base::File::FLAG_READ |
+                                 base::File::FLAG_SEQUENTIAL_SCAN);
+  if (!file.IsValid())
     return false;
-  }
 
-  std::string file_data;
-  file_data.resize(file_size);
-  if (!base::ReadFileToString(file_path, &file_data))
+  // Compare file and stream sizes first. Quick and will save us some time if
+  // they are different sizes.
+  int64_t file_size = file.GetLength();
+  if (file_size < 0 || static_cast<uint64_t>(file_size) != data.size())
     return false;
 
-  return file_data == data;
+  // Compare one chunk at a time rather than reading the whole file, so a
+  // difference near the start of a big file is found quickly and no buffer
+  // the size of the file is needed. The buffer is on the heap since this runs
+  // on worker threads, whose stacks can be small.
+  const size_t kChunkSize = 64 * 1024;
+  std::unique_ptr<char[]> buffer(new char[std::min(kChunkSize, data.size())]);
+  size_t offset = 0;
+  while (offset < data.size()) {
+    int to_read = static_cast<int>(std::min(kChunkSize, data.size() - offset));
+    if (file.ReadAtCurrentPos(buffer.get(), to_read) != to_read ||
+        memcmp(buffer.get(), &data[offset], to_read) != 0)
+      return false;
+    offset += to_read;
+  }
+  return true;
 }
 
 bool WriteFileIfChanged(const base::FilePath& file_path,
@@ -966,7 +983,9 @@ bool WriteFile(const base::FilePath& file_path,
   write_success = base::WriteFile(file_path, data.c_str(), size) == size;
 #endif
 
-  if (!write_success && err) {
+  if (write_success) {
+    AddToTraceCounter(TRACE_COUNTER_BYTES_WRITTEN, size);
+  } else if (err) {
     *err = Err(Location(), "Unable to write file.",
                "I was writing \"" + FilePathToUTF8(file_path) + "\".");
   }
@@ -636,6 +636,19 @@ TEST(FilesystemUtils, ContentsEqual) {
 
   // The same length, different contents.
   EXPECT_FALSE(ContentsEqual(file_path, "bar"));
+
+  // Files bigger than one read, differing only in the last byte.
+  data = std::string(200 * 1024 + 1, 'x');
+  base::WriteFile(file_path, data.c_str(), static_cast<int>(data.size()));
+  EXPECT_TRUE(ContentsEqual(file_path, data));
+  data.back() = 'y';
+  EXPECT_FALSE(ContentsEqual(file_path, data));
+
+  // Empty file.
+  base::WriteFile(file_path, "", 0);
+  EXPECT_TRUE(ContentsEqual(file_path, std::string()));
+  EXPECT_FALSE(ContentsEqual(temp_dir.GetPath().AppendASCII("missing"),
+                             std::string()));
 }
 
 TEST(FilesystemUtils, WriteFileIfChanged) {
@@ -9,6 +9,7 @@
 #include "base/strings/utf_string_conversions.h"
 #include "tools/gn/err.h"
 #include "tools/gn/exec_process.h"
+#include "tools/gn/exec_script_cache.h"
 #include "tools/gn/filesystem_utils.h"
 #include "tools/gn/functions.h"
 #include "tools/gn/input_conversion.h"
@@ -19,6 +20,7 @@
 #include "tools/gn/value.h"
 #include "util/build_config.h"
 #include "util/ticks.h"
+#include "util/worker_pool.h"
 
 namespace functions {
 
@@ -58,6 +60,21 @@ bool CheckExecScriptPermissions(const BuildSettings* build_settings,
   return false;
 }
 
+// ExecScriptCache::Runner that starts the process.
+void RunScriptProcess(const base::CommandLine& cmdline,
+                      const base::FilePath& startup_dir,
+                      ExecScriptCache::Result* result) {
+  g_scheduler->BeginScriptProcess();
+  {
+    // Lets another thread run load tasks while this one waits.
+    WorkerPool::ScopedBlockingCall blocking_call;
+    result->executed =
+        internal::ExecProcess(cmdline, startup_dir, &result->output,
+                              &result->stderr_output, &result->exit_code);
+  }
+  g_scheduler->EndScriptProcess();
+}
+
 }  // namespace
 
 const char kExecScript[] = "exec_script";
@@ -85,6 +102,16 @@ const char kExecScript_Help[] =
   "python.bat" on Windows). This can be configured by the script_executable
   variable, see "gn help dotfile".
 
+  A script is run at most once per GN run for a given command line: later calls
+  with the same interpreter, script and arguments reuse the first output. With
+  the --exec-script-cache switch, successful outputs are also kept in the build
+  directory and reused by later runs while the script and its
+  file_dependencies are unchanged, so only use it when the scripts' output
+  depends on nothing else.
+
+  Scripts called from different build files can run at the same time. See
+  "gn help --exec-script-jobs" to limit how many.
+
 Arguments:
 
   filename:
@@ -165,6 +192,8 @@ Value RunExecScript(Scope* scope,
 
   // Add all dependencies of this script, including the script itself, to the
   // build deps.
+  std::vector<base::FilePath> dependencies;
+  dependencies.push_back(script_path);
   g_scheduler->AddGenDependency(script_path);
   if (args.size() >= 4) {
     const Value& deps_value = args[3];
@@ -174,13 +203,14 @@ Value RunExecScript(Scope* scope,
     for (const auto& dep : deps_value.list_value()) {
       if (!dep.VerifyTypeIs(Value::STRING, err))
         return Value();
-      g_scheduler->AddGenDependency(build_settings->GetFullPath(
+      dependencies.push_back(build_settings->GetFullPath(
           cur_dir.ResolveRelativeAs(
               true, dep, err,
               scope->settings()->build_settings()->root_path_utf8()),
           true));
       if (err->has_error())
         return Value();
+      g_scheduler->AddGenDependency(dependencies.back());
     }
   }
 
@@ -244,21 +274,23 @@ Value RunExecScript(Scope* scope,
   // or not and skip creating the directory.
   base::CreateDirectory(startup_dir);
 
-  // Execute the process.
+  // Execute the process, unless the same command already ran.
   // TODO(brettw) set the environment block.
-  std::string output;
-  std::string stderr_output;
-  int exit_code = 0;
-  {
-    if (!internal::ExecProcess(cmdline, startup_dir, &output, &stderr_output,
-                               &exit_code)) {
-      *err = Err(
-          function->function(), "Could not execute interpreter.",
-          "I was trying to execute \"" + FilePathToUTF8(interpreter_path) +
-          "\".");
-      return Value();
-    }
+  std::string cache_key = FilePathToUTF8(cmdline.GetCommandLineString()) +
+                          "\n" + FilePathToUTF8(startup_dir);
+  ExecScriptCache::Result result = g_scheduler->exec_script_cache()->Run(
+      cache_key, dependencies,
+      base::Bind(&RunScriptProcess, cmdline, startup_dir));
+  if (!result.executed) {
+    *err = Err(
+        function->function(), "Could not execute interpreter.",
+        "I was trying to execute \"" + FilePathToUTF8(interpreter_path) +
+        "\".");
+    return Value();
   }
+  const std::string& output = result.output;
+  const std::string& stderr_output = result.stderr_output;
+  int exit_code = result.exit_code;
   if (g_scheduler->verbose_logging()) {
     g_scheduler->Log(
         "Executing",
@@ -21,7 +21,6 @@
 #include "tools/gn/source_file_type.h"
 #include "tools/gn/target.h"
 #include "tools/gn/trace.h"
-#include "util/worker_pool.h"
 
 namespace {
 
@@ -101,6 +100,43 @@ std::string GetDependencyChainPublicError(const HeaderChecker::Chain& chain) {
   return ret;
 }
 
+// Returns true if the given file of the target is a C-like source file that
+// gets checked (RC files also have includes).
+bool IsCheckedSourceType(const Target* target, const SourceFile& file) {
+  SourceFileType type = target->toolchain()->GetSourceFileType(file);
+  return type == SOURCE_CPP || type == SOURCE_H || type == SOURCE_C ||
+         type == SOURCE_M || type == SOURCE_MM || type == SOURCE_RC;
+}
+
+// Reads the file at |path| into |input_file| and finds its includes, adding
+// them to |cache| if it's non-null. Returns false if the file can't be read.
+bool ReadAndScanFile(const base::FilePath& path,
+                     InputFile* input_file,
+                     std::vector<IncludeScanCache::Include>* includes,
+                     IncludeScanCache* cache) {
+  // Stat before reading so a change in between isn't cached as the new
+  // version of the file.
+  base::File::Info info;
+  if (cache && !base::GetFileInfo(path, &info))
+    cache = nullptr;
+
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return false;
+  input_file->SetContents(contents);
+
+  CIncludeIterator iter(input_file);
+  base::StringPiece current_include;
+  LocationRange range;
+  while (iter.GetNextIncludeString(&current_include, &range)) {
+    includes->emplace_back(current_include, range.begin().line_number(),
+                           range.begin().column_number());
+  }
+  if (cache)
+    cache->Add(path, info, input_file->contents(), *includes);
+  return true;
+}
+
 // Returns true if the two targets have the same label not counting the
 // toolchain.
 bool TargetLabelsMatchExceptToolchain(const Target* a, const Target* b) {
@@ -122,7 +158,7 @@ HeaderChecker::HeaderChecker(const BuildSettings* build_settings,
                              const std::vector<const Target*>& targets,
                              bool check_generated)
     : build_settings_(build_settings), check_generated_(check_generated),
-      lock_(), task_count_cv_() {
+      include_scan_cache_(nullptr), lock_(), task_count_cv_() {
   for (auto* target : targets)
     AddTargetToFileMap(target, &file_map_);
 }
@@ -148,15 +184,10 @@ bool HeaderChecker::Run(const std::vector<const Target*>& to_check,
 }
 
 void HeaderChecker::RunCheckOverFiles(const FileMap& files, bool force_check) {
-  WorkerPool pool;
-
   for (const auto& file : files) {
     bool is_source = false;
     for (const auto& vect_i : file_map_[file.first]) {
-      // Only check C-like source files (RC files also have includes).
-      SourceFileType type = vect_i.target->toolchain()->GetSourceFileType(file.first);
-      if (type == SOURCE_CPP || type == SOURCE_H || type == SOURCE_C ||
-          type == SOURCE_M || type == SOURCE_MM || type == SOURCE_RC)
+      if (IsCheckedSourceType(vect_i.target, file.first))
         is_source = true;
     }
     if (!is_source)
@@ -176,8 +207,8 @@ void HeaderChecker::RunCheckOverFiles(const FileMap& files, bool force_check) {
     for (const auto& vect_i : file.second) {
       if (vect_i.target->check_includes()) {
         task_count_.Increment();
-        pool.PostTask(base::BindOnce(&HeaderChecker::DoWork, this,
-                                     vect_i.target, file.first));
+        g_scheduler->PostPoolTask(base::BindOnce(&HeaderChecker::DoWork, this,
+                                                 vect_i.target, file.first));
       }
     }
   }
@@ -202,6 +233,30 @@ void HeaderChecker::DoWork(const Target* target, const SourceFile& file) {
   }
 }
 
+// static
+void HeaderChecker::ScanTargetIncludes(const BuildSettings* build_settings,
+                                       const Target* target,
+                                       IncludeScanCache* cache) {
+  FileMap files;
+  AddTargetToFileMap(target, &files);
+
+  const std::string& build_dir = build_settings->build_dir().value();
+  for (const auto& file : files) {
+    // Generated files are skipped by the check, see CheckFile().
+    if (file.second[0].is_generated ||
+        file.first.value().compare(0, build_dir.size(), build_dir) == 0 ||
+        !IsCheckedSourceType(target, file.first))
+      continue;
+
+    base::FilePath path = build_settings->GetFullPath(file.first);
+    std::vector<IncludeScanCache::Include> includes;
+    if (cache->Lookup(path, &includes))
+      continue;
+    InputFile input_file(file.first);
+    ReadAndScanFile(path, &input_file, &includes, cache);
+  }
+}
+
 // static
 void HeaderChecker::AddTargetToFileMap(const Target* target, FileMap* dest) {
   // Files in the sources have this public bit by default.
@@ -282,26 +337,48 @@ bool HeaderChecker::CheckFile(const Target* from_target,
     return true;
 
   base::FilePath path = build_settings_->GetFullPath(file);
-  std::string contents;
-  if (!base::ReadFileToString(path, &contents)) {
+  InputFile input_file(file);
+  std::vector<IncludeScanCache::Include> includes;
+  bool cached =
+      include_scan_cache_ && include_scan_cache_->Lookup(path, &includes);
+  if (!cached &&
+      !ReadAndScanFile(path, &input_file, &includes, include_scan_cache_)) {
     // A missing (not yet) generated file is an acceptable problem
     // considering this code does not understand conditional includes.
     if (IsFileInOuputDir(file))
       return true;
 
-    errors->emplace_back(from_target->defined_from(), "Source file not found.",
-                         "The target:\n  " +
-                             from_target->label().GetUserVisibleName(false) +
-                             "\nhas a source file:\n  " + file.value() +
-                             "\nwhich was not found.");
+    errors->emplace_back(
+        from_target->defined_from(), "Source file not found.",
+        "The target:\n  " + from_target->label().GetUserVisibleName(false) +
+            "\nhas a source file:\n  " + file.value() +
+            "\nwhich was not found.");
     return false;
   }
 
-  InputFile input_file(file);
-  input_file.SetContents(contents);
+  size_t error_count_before = errors->size();
+  CheckIncludes(from_target, input_file, includes, errors);
+  if (cached && errors->size() != error_count_before) {
+    // The errors point into the file contents, which weren't read for a
+    // cached file. Errors are rare, so just do the check again.
+    std::string contents;
+    if (base::ReadFileToString(path, &contents)) {
+      errors->erase(errors->begin() + error_count_before, errors->end());
+      input_file.SetContents(contents);
+      CheckIncludes(from_target, input_file, includes, errors);
+    }
+  }
 
+  return errors->size() == error_count_before;
+}
+
+void HeaderChecker::CheckIncludes(
+    const Target* from_target,
+    const InputFile& source_file,
+    const std::vector<IncludeScanCache::Include>& includes,
+    std::vector<Err>* errors) const {
   std::vector<SourceDir> include_dirs;
-  include_dirs.push_back(file.GetDir());
+  include_dirs.push_back(source_file.name().GetDir());
   for (ConfigValuesIterator iter(from_target); !iter.done(); iter.Next()) {
     const std::vector<SourceDir>& target_include_dirs =
         iter.cur().include_dirs();
@@ -309,19 +386,20 @@ bool HeaderChecker::CheckFile(const Target* from_target,
                         target_include_dirs.end());
   }
 
-  size_t error_count_before = errors->size();
-  CIncludeIterator iter(&input_file);
-  base::StringPiece current_include;
-  LocationRange range;
-  while (iter.GetNextIncludeString(&current_include, &range)) {
+  for (const IncludeScanCache::Include& current_include : includes) {
+    LocationRange range(
+        Location(&source_file, current_include.line, current_include.column,
+                 -1),
+        Location(&source_file, current_include.line,
+                 current_include.column +
+                     static_cast<int>(current_include.path.size()),
+                 -1));
     Err err;
-    SourceFile include = SourceFileForInclude(current_include, include_dirs,
-                                              input_file, range, &err);
+    SourceFile include = SourceFileForInclude(
+        current_include.path, include_dirs, source_file, range, &err);
     if (!include.is_null())
-      CheckInclude(from_target, input_file, include, range, errors);
+      CheckInclude(from_target, source_file, include, range, errors);
   }
-
-  return errors->size() == error_count_before;
 }
 
 // If the file exists:
@@ -16,6 +16,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/strings/string_piece.h"
 #include "tools/gn/err.h"
+#include "tools/gn/include_scan_cache.h"
 #include "tools/gn/source_dir.h"
 
 class BuildSettings;
@@ -66,6 +67,20 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
            bool force_check,
            std::vector<Err>* errors);
 
+  // Sets the cache used to avoid reading and scanning unchanged files. May be
+  // null (the default). The cache must outlive Run().
+  void set_include_scan_cache(IncludeScanCache* cache) {
+    include_scan_cache_ = cache;
+  }
+
+  // Reads and scans the files of |target| that Run() would check into
+  // |cache|, so that checking them later doesn't have to go to the disk. This
+  // lets "gn gen --check" do the I/O while targets are still being loaded and
+  // written. Can be called on any thread once the target is resolved.
+  static void ScanTargetIncludes(const BuildSettings* build_settings,
+                                 const Target* target,
+                                 IncludeScanCache* cache);
+
  private:
   friend class base::RefCountedThreadSafe<HeaderChecker>;
   FRIEND_TEST_ALL_PREFIXES(HeaderCheckerTest, IsDependencyOf);
@@ -123,6 +138,13 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
                  const SourceFile& file,
                  std::vector<Err>* err) const;
 
+  // Checks the given includes of |source_file|, which is in |from_target|,
+  // adding any errors to |errors|.
+  void CheckIncludes(const Target* from_target,
+                     const InputFile& source_file,
+                     const std::vector<IncludeScanCache::Include>& includes,
+                     std::vector<Err>* errors) const;
+
   // Checks that the given file in the given target can include the
   // given include file. If disallowed, adds the error or errors to
   // the errors array.  The range indicates the location of the
@@ -177,6 +199,8 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
 
   bool check_generated_;
 
+  IncludeScanCache* include_scan_cache_;
+
   // Maps source files to targets it appears in (usually just one target).
   FileMap file_map_;
 
@@ -0,0 +1,166 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/include_scan_cache.h"
+
+#include <utility>
+
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "tools/gn/filesystem_utils.h"
+
+namespace {
+
+const char kIncludeScanCacheMagic[] = "GNIC";
+
+// Increment when the entry layout or the include scanner changes.
+const uint32_t kIncludeScanCacheVersion = 1;
+
+}  // namespace
+
+IncludeScanCache::Include::Include() : line(0), column(0) {}
+
+IncludeScanCache::Include::Include(const base::StringPiece& path,
+                                   int line,
+                                   int column)
+    : path(path.as_string()), line(line), column(column) {}
+
+IncludeScanCache::Entry::Entry() : used(false) {}
+
+IncludeScanCache::Entry::~Entry() = default;
+
+IncludeScanCache::IncludeScanCache(const base::FilePath& cache_file)
+    : cache_file_(cache_file), dirty_(false), hit_count_(0) {}
+
+IncludeScanCache::~IncludeScanCache() = default;
+
+void IncludeScanCache::Load() {
+  std::string body;
+  if (!ReadCacheFile(cache_file_, kIncludeScanCacheMagic,
+                     kIncludeScanCacheVersion, &body))
+    return;
+
+  std::unordered_map<std::string, Entry> entries;
+  CacheReader reader(body);
+  uint64_t count;
+  if (!reader.ReadVarint(&count))
+    return;
+  for (uint64_t i = 0; i < count; i++) {
+    base::StringPiece name;
+    Entry entry;
+    uint64_t include_count;
+    if (!reader.ReadString(&name) || !entry.stamp.Read(&reader) ||
+        !reader.ReadVarint(&include_count))
+      return;  // Corrupt, ignore the whole file.
+    for (uint64_t j = 0; j < include_count; j++) {
+      base::StringPiece path;
+      int line;
+      int column;
+      if (!reader.ReadString(&path) || !reader.ReadInt(&line) ||
+          !reader.ReadInt(&column))
+        return;
+      entry.includes.emplace_back(path, line, column);
+    }
+    entries[name.as_string()] = std::move(entry);
+  }
+  if (!reader.at_end())
+    return;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_ = std::move(entries);
+}
+
+bool IncludeScanCache::Save() {
+  CacheWriter writer;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    size_t used_count = 0;
+    for (const auto& pair : entries_) {
+      if (pair.second.used)
+        used_count++;
+    }
+    if (!dirty_ && used_count == entries_.size())
+      return true;  // Nothing changed.
+
+    writer.WriteVarint(used_count);
+    for (const auto& pair : entries_) {
+      if (!pair.second.used)
+        continue;
+      writer.WriteString(pair.first);
+      pair.second.stamp.Write(&writer);
+      writer.WriteVarint(pair.second.includes.size());
+      for (const Include& include : pair.second.includes) {
+        writer.WriteString(include.path);
+        writer.WriteVarint(static_cast<uint64_t>(include.line));
+        writer.WriteVarint(static_cast<uint64_t>(include.column));
+      }
+    }
+  }
+  return WriteCacheFile(cache_file_, kIncludeScanCacheMagic,
+                        kIncludeScanCacheVersion, writer);
+}
+
+bool IncludeScanCache::Lookup(const base::FilePath& path,
+                              std::vector<Include>* includes) {
+  const std::string name = FilePathToUTF8(path);
+  FileStamp cached;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = entries_.find(name);
+    if (found == entries_.end())
+      return false;
+    if (found->second.used) {
+      // Already checked against the file during this run.
+      *includes = found->second.includes;
+      hit_count_++;
+      return true;
+    }
+    cached = found->second.stamp;
+  }
+
+  base::File::Info info;
+  if (!base::GetFileInfo(path, &info) || info.size != cached.size)
+    return false;
+
+  Ticks last_modified = cached.last_modified;
+  if (info.last_modified != cached.last_modified) {
+    // Touched, but maybe not changed.
+    FileStamp stamp;
+    if (!GetFileStamp(path, &stamp) || !stamp.SameContents(cached))
+      return false;
+    last_modified = stamp.last_modified;
+  }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  Entry& entry = entries_[name];
+  entry.used = true;
+  if (entry.stamp.last_modified != last_modified) {
+    // Remember the new time for the next run.
+    entry.stamp.last_modified = last_modified;
+    dirty_ = true;
+  }
+  *includes = entry.includes;
+  hit_count_++;
+  return true;
+}
+
+void IncludeScanCache::Add(const base::FilePath& path,
+                           const base::File::Info& info,
+                           const base::StringPiece& contents,
+                           const std::vector<Include>& includes) {
+  Entry entry;
+  if (!GetFileStampForContents(info, contents, &entry.stamp))
+    return;
+  entry.includes = includes;
+  entry.used = true;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_[FilePathToUTF8(path)] = std::move(entry);
+  dirty_ = true;
+}
+
+int IncludeScanCache::hit_count() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return hit_count_;
+}
@@ -0,0 +1,92 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_INCLUDE_SCAN_CACHE_H_
+#define TOOLS_GN_INCLUDE_SCAN_CACHE_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "tools/gn/cache_file.h"
+
+// Persistent cache of the includes found in source files by the header
+// checker, stored in the build directory.
+//
+// Entries are keyed by the physical path of the file. An entry is used without
+// reading the file when its size and modification time are unchanged. If only
+// the modification time changed, the file is read and the entry is still used
+// when the contents digest matches. Files are assumed not to change during a
+// run, so entries added or looked up once aren't checked again.
+//
+// This class is threadsafe.
+class IncludeScanCache {
+ public:
+  // A checked include (see CIncludeIterator) of a file.
+  struct Include {
+    Include();
+    Include(const base::StringPiece& path, int line, int column);
+
+    std::string path;  // The quoted part of the #include line.
+    int line;          // One-based line number.
+    int column;        // Column where |path| begins.
+  };
+
+  explicit IncludeScanCache(const base::FilePath& cache_file);
+  ~IncludeScanCache();
+
+  // Reads the entries from the cache file. A missing or invalid cache file
+  // leaves the cache empty.
+  void Load();
+
+  // Writes the entries used during this run to the cache file, if anything
+  // changed since it was loaded. Entries that weren't used are dropped.
+  bool Save();
+
+  // Fills |includes| with the cached includes of the file at |path|. Returns
+  // false if there is no entry or the file changed.
+  bool Lookup(const base::FilePath& path, std::vector<Include>* includes);
+
+  // Adds the includes of the file at |path| whose contents are |contents|.
+  // |info| must be stat'ed before the contents are read (see
+  // GetFileStampForContents()).
+  void Add(const base::FilePath& path,
+           const base::File::Info& info,
+           const base::StringPiece& contents,
+           const std::vector<Include>& includes);
+
+  // Number of successful lookups.
+  int hit_count() const;
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    FileStamp stamp;
+    std::vector<Include> includes;
+    bool used;
+  };
+
+  base::FilePath cache_file_;
+
+  mutable std::mutex lock_;
+
+  // Maps physical file names to entries.
+  std::unordered_map<std::string, Entry> entries_;
+
+  // Set when an entry was added or updated.
+  bool dirty_;
+
+  int hit_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(IncludeScanCache);
+};
+
+#endif  // TOOLS_GN_INCLUDE_SCAN_CACHE_H_
@@ -0,0 +1,102 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "tools/gn/include_scan_cache.h"
+#include "util/test/test.h"
+
+namespace {
+
+void WriteSource(const base::FilePath& path, const std::string& contents) {
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(path, contents.c_str(),
+                            static_cast<int>(contents.size())));
+}
+
+}  // namespace
+
+TEST(IncludeScanCache, LookupAfterSave) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath cache_file = temp_dir.GetPath().AppendASCII("gn.cache");
+  base::FilePath a = temp_dir.GetPath().AppendASCII("a.cc");
+  base::FilePath b = temp_dir.GetPath().AppendASCII("b.cc");
+
+  const std::string a_contents = "#include \"a.h\"\n";
+  WriteSource(a, a_contents);
+  WriteSource(b, "#include \"b.h\"\n");
+
+  base::File::Info a_info;
+  base::File::Info b_info;
+  ASSERT_TRUE(base::GetFileInfo(a, &a_info));
+  ASSERT_TRUE(base::GetFileInfo(b, &b_info));
+
+  std::vector<IncludeScanCache::Include> includes;
+  {
+    IncludeScanCache cache(cache_file);
+    cache.Load();
+    EXPECT_FALSE(cache.Lookup(a, &includes));
+    cache.Add(a, a_info, a_contents,
+              std::vector<IncludeScanCache::Include>{
+                  IncludeScanCache::Include("a.h", 1, 11)});
+    cache.Add(b, b_info, "#include \"b.h\"\n",
+              std::vector<IncludeScanCache::Include>());
+    EXPECT_TRUE(cache.Save());
+  }
+
+  // Rewriting a file with the same contents keeps its entry.
+  WriteSource(a, a_contents);
+  {
+    IncludeScanCache cache(cache_file);
+    cache.Load();
+    ASSERT_TRUE(cache.Lookup(a, &includes));
+    ASSERT_EQ(1u, includes.size());
+    EXPECT_EQ("a.h", includes[0].path);
+    EXPECT_EQ(1, includes[0].line);
+    EXPECT_EQ(11, includes[0].column);
+    EXPECT_EQ(1, cache.hit_count());
+
+    // b wasn't used, so it's dropped from the file.
+    EXPECT_TRUE(cache.Save());
+  }
+
+  WriteSource(a, "#include \"a2.h\"\n");
+  {
+    IncludeScanCache cache(cache_file);
+    cache.Load();
+    EXPECT_FALSE(cache.Lookup(a, &includes));
+    EXPECT_FALSE(cache.Lookup(b, &includes));
+  }
+}
+
+// A file that changed between being stat'ed and read isn't cached.
+TEST(IncludeScanCache, ChangedWhileReading) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath cache_file = temp_dir.GetPath().AppendASCII("gn.cache");
+  base::FilePath a = temp_dir.GetPath().AppendASCII("a.cc");
+
+  WriteSource(a, "#include \"a.h\"\n");
+  base::File::Info info;
+  ASSERT_TRUE(base::GetFileInfo(a, &info));
+  const std::string new_contents = "#include \"a2.h\"\n";
+  WriteSource(a, new_contents);
+
+  {
+    IncludeScanCache cache(cache_file);
+    cache.Add(a, info, new_contents,
+              std::vector<IncludeScanCache::Include>{
+                  IncludeScanCache::Include("a2.h", 1, 11)});
+    EXPECT_TRUE(cache.Save());
+  }
+
+  IncludeScanCache cache(cache_file);
+  cache.Load();
+  std::vector<IncludeScanCache::Include> includes;
+  EXPECT_FALSE(cache.Lookup(a, &includes));
+}
@@ -8,8 +8,12 @@
 #include <utility>
 
 #include "base/bind.h"
+#include "base/files/file.h"
+#include "base/files/file_util.h"
 #include "base/stl_util.h"
+#include "tools/gn/arena.h"
 #include "tools/gn/filesystem_utils.h"
+#include "tools/gn/parse_cache.h"
 #include "tools/gn/parser.h"
 #include "tools/gn/scheduler.h"
 #include "tools/gn/scope_per_file_provider.h"
@@ -18,6 +22,9 @@
 
 namespace {
 
+// Rough size of the parse tree relative to the file it's parsed from.
+const size_t kParseTreeBytesPerInputByte = 16;
+
 // The opposite of std::lock_guard.
 struct ScopedUnlock {
   ScopedUnlock(std::unique_lock<std::mutex>& lock) : lock_(lock) {
@@ -34,10 +41,22 @@ void InvokeFileLoadCallback(const InputFileManager::FileLoadCallback& cb,
   cb.Run(node);
 }
 
+// Loads |file| from |path|. When |info| is non-null, the file is stat'ed into
+// it first, as the parse cache requires.
+bool StatAndLoadFile(const base::FilePath& path,
+                     base::File::Info* info,
+                     InputFile* file) {
+  if (info && !base::GetFileInfo(path, info))
+    return false;
+  return file->Load(path);
+}
+
 bool DoLoadFile(const LocationRange& origin,
                 const BuildSettings* build_settings,
                 const SourceFile& name,
+                ParseCache* parse_cache,
                 InputFile* file,
+                std::unique_ptr<Arena>* arena,
                 std::vector<Token>* tokens,
                 std::unique_ptr<ParseNode>* root,
                 Err* err) {
@@ -52,13 +71,15 @@ bool DoLoadFile(const LocationRange& origin,
 
   // Read.
   base::FilePath primary_path = build_settings->GetFullPath(name);
+  base::File::Info info;
+  base::File::Info* info_for_cache = parse_cache ? &info : nullptr;
   ScopedTrace load_trace(TraceItem::TRACE_FILE_LOAD, name.value());
-  if (!file->Load(primary_path)) {
+  if (!StatAndLoadFile(primary_path, info_for_cache, file)) {
     if (!build_settings->secondary_source_path().empty()) {
       // Fall back to secondary source tree.
       base::FilePath secondary_path =
           build_settings->GetFullPathSecondary(name);
-      if (!file->Load(secondary_path)) {
+      if (!StatAndLoadFile(secondary_path, info_for_cache, file)) {
         *err = Err(origin, "Can't load input file.",
                    "Unable to load:\n  " + FilePathToUTF8(primary_path) +
                        "\n"
@@ -74,8 +95,20 @@ bool DoLoadFile(const LocationRange& origin,
   }
   load_trace.Done();
 
+  // The nodes of a file live as long as the file, so they're allocated
+  // together instead of one by one.
+  *arena = std::make_unique<Arena>(file->contents().size() *
+                                   kParseTreeBytesPerInputByte);
+  ScopedParseNodeArena scoped_arena(arena->get());
+
   ScopedTrace exec_trace(TraceItem::TRACE_FILE_PARSE, name.value());
 
+  FileStamp stamp;
+  if (parse_cache && parse_cache->Lookup(file, info, &stamp, tokens, root)) {
+    exec_trace.Done();
+    return true;
+  }
+
   // Tokenize.
   *tokens = Tokenizer::Tokenize(file, err);
   if (err->has_error())
@@ -86,6 +119,9 @@ bool DoLoadFile(const LocationRange& origin,
   if (err->has_error())
     return false;
 
+  if (parse_cache)
+    parse_cache->Add(file, stamp, *tokens, root->get());
+
   exec_trace.Done();
   return true;
 }
@@ -255,6 +291,16 @@ int InputFileManager::GetInputFileCount() const {
   return static_cast<int>(input_files_.size());
 }
 
+const InputFile* InputFileManager::GetLoadedFile(
+    const SourceFile& name) const {
+  std::lock_guard<std::mutex> lock(lock_);
+  InputFileMap::const_iterator found = input_files_.find(name);
+  if (found == input_files_.end() || !found->second->loaded ||
+      !found->second->parsed_root)
+    return nullptr;
+  return &found->second->file;
+}
+
 void InputFileManager::GetAllPhysicalInputFileNames(
     std::vector<base::FilePath>* result) const {
   std::lock_guard<std::mutex> lock(lock_);
@@ -265,6 +311,16 @@ void InputFileManager::GetAllPhysicalInputFileNames(
   }
 }
 
+void InputFileManager::EnableParseCache(const base::FilePath& cache_file) {
+  parse_cache_ = std::make_unique<ParseCache>(cache_file);
+  parse_cache_->Load();
+}
+
+void InputFileManager::SaveParseCache() {
+  if (parse_cache_)
+    parse_cache_->Save();
+}
+
 void InputFileManager::BackgroundLoadFile(const LocationRange& origin,
                                           const BuildSettings* build_settings,
                                           const SourceFile& name,
@@ -279,10 +335,12 @@ bool InputFileManager::LoadFile(const LocationRange& origin,
                                 const SourceFile& name,
                                 InputFile* file,
                                 Err* err) {
+  std::unique_ptr<Arena> arena;
   std::vector<Token> tokens;
   std::unique_ptr<ParseNode> root;
   bool success =
-      DoLoadFile(origin, build_settings, name, file, &tokens, &root, err);
+      DoLoadFile(origin, build_settings, name, parse_cache_.get(), file,
+                 &arena, &tokens, &root, err);
   // Can't return early. We have to ensure that the completion event is
   // signaled in all cases bacause another thread could be blocked on this one.
 
@@ -298,6 +356,7 @@ bool InputFileManager::LoadFile(const LocationRange& origin,
     InputFileData* data = input_files_[name].get();
     data->loaded = true;
     if (success) {
+      data->arena = std::move(arena);
       data->tokens.swap(tokens);
       data->parsed_root = std::move(root);
     } else {
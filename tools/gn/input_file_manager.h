@@ -21,8 +21,10 @@
 #include "tools/gn/settings.h"
 #include "util/auto_reset_event.h"
 
+class Arena;
 class Err;
 class LocationRange;
+class ParseCache;
 class ParseNode;
 class Token;
 
@@ -87,9 +89,25 @@ class InputFileManager : public base::RefCountedThreadSafe<InputFileManager> {
   // Does not count dynamic input.
   int GetInputFileCount() const;
 
+  // Returns the given file if it has been successfully loaded, or null. The
+  // returned file is immutable and lives as long as this class.
+  const InputFile* GetLoadedFile(const SourceFile& name) const;
+
   // Fills the vector with all input files.
   void GetAllPhysicalInputFileNames(std::vector<base::FilePath>* result) const;
 
+  // Enables the persistent parse cache stored in |cache_file|, loading any
+  // existing entries. Files loaded before this (like the imports of the .gn
+  // file) are not cached. Must not be called while files are being loaded.
+  void EnableParseCache(const base::FilePath& cache_file);
+
+  // Writes the parse cache back to disk if it's enabled. Must be called once
+  // all loads are complete.
+  void SaveParseCache();
+
+  // Null unless the parse cache is enabled.
+  ParseCache* parse_cache() { return parse_cache_.get(); }
+
  private:
   friend class base::RefCountedThreadSafe<InputFileManager>;
 
@@ -113,6 +131,9 @@ class InputFileManager : public base::RefCountedThreadSafe<InputFileManager> {
     // only happens for imports).
     std::unique_ptr<AutoResetEvent> completion_event;
 
+    // Holds the nodes of |parsed_root|, so it must be declared before it.
+    std::unique_ptr<Arena> arena;
+
     std::vector<Token> tokens;
 
     // Null before the file is loaded or if loading failed.
@@ -149,6 +170,9 @@ class InputFileManager : public base::RefCountedThreadSafe<InputFileManager> {
   // See AddDynamicInput().
   std::vector<std::unique_ptr<InputFileData>> dynamic_inputs_;
 
+  // Set once before loading starts, so it can be read without the lock.
+  std::unique_ptr<ParseCache> parse_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(InputFileManager);
 };
 
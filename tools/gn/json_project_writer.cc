@@ -207,7 +207,7 @@ bool JSONProjectWriter::RunAndWriteFiles(
 
   std::string json = RenderJSON(build_settings, builder, targets);
   if (!ContentsEqual(output_path, json)) {
-    if (!WriteFileIfChanged(output_path, json, err)) {
+    if (!WriteFile(output_path, json, err)) {
       return false;
     }
 
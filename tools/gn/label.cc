@@ -256,14 +256,13 @@ Label::Label(const SourceDir& dir,
              const base::StringPiece& name,
              const SourceDir& toolchain_dir,
              const base::StringPiece& toolchain_name)
-    : dir_(dir), toolchain_dir_(toolchain_dir) {
-  name_.assign(name.data(), name.size());
-  toolchain_name_.assign(toolchain_name.data(), toolchain_name.size());
-}
+    : dir_(dir),
+      name_(name),
+      toolchain_dir_(toolchain_dir),
+      toolchain_name_(toolchain_name) {}
 
-Label::Label(const SourceDir& dir, const base::StringPiece& name) : dir_(dir) {
-  name_.assign(name.data(), name.size());
-}
+Label::Label(const SourceDir& dir, const base::StringPiece& name)
+    : dir_(dir), name_(name) {}
 
 Label::Label(const Label& other) = default;
 
@@ -285,37 +284,41 @@ Label Label::Resolve(const SourceDir& current_dir,
     return ret;
   }
 
+  std::string name;
+  std::string toolchain_name;
   if (!::Resolve(current_dir, current_toolchain, input, input_string, &ret.dir_,
-                 &ret.name_, &ret.toolchain_dir_, &ret.toolchain_name_, err))
+                 &name, &ret.toolchain_dir_, &toolchain_name, err))
     return Label();
+  ret.name_ = StringAtom(name);
+  ret.toolchain_name_ = StringAtom(toolchain_name);
   return ret;
 }
 
 Label Label::GetToolchainLabel() const {
-  return Label(toolchain_dir_, toolchain_name_);
+  return Label(toolchain_dir_, toolchain_name_.str());
 }
 
 Label Label::GetWithNoToolchain() const {
-  return Label(dir_, name_);
+  return Label(dir_, name_.str());
 }
 
 std::string Label::GetUserVisibleName(bool include_toolchain) const {
   std::string ret;
-  ret.reserve(dir_.value().size() + name_.size() + 1);
+  ret.reserve(dir_.value().size() + name_.str().size() + 1);
 
   if (dir_.is_null())
     return ret;
 
   ret = DirWithNoTrailingSlash(dir_);
   ret.push_back(':');
-  ret.append(name_);
+  ret.append(name_.str());
 
   if (include_toolchain) {
     ret.push_back('(');
     if (!toolchain_dir_.is_null() && !toolchain_name_.empty()) {
       ret.append(DirWithNoTrailingSlash(toolchain_dir_));
       ret.push_back(':');
-      ret.append(toolchain_name_);
+      ret.append(toolchain_name_.str());
     }
     ret.push_back(')');
   }
@@ -324,6 +327,6 @@ std::string Label::GetUserVisibleName(bool include_toolchain) const {
 
 std::string Label::GetUserVisibleName(const Label& default_toolchain) const {
   bool include_toolchain = default_toolchain.dir() != toolchain_dir_ ||
-                           default_toolchain.name() != toolchain_name_;
+                           default_toolchain.name_ != toolchain_name_;
   return GetUserVisibleName(include_toolchain);
 }
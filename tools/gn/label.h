@@ -7,7 +7,10 @@
 
 #include <stddef.h>
 
+#include <utility>
+
 #include "tools/gn/source_dir.h"
+#include "tools/gn/string_atom.h"
 
 class Err;
 class Value;
@@ -15,6 +18,9 @@ class Value;
 // A label represents the name of a target or some other named thing in
 // the source path. The label is always absolute and always includes a name
 // part, so it starts with a slash, and has one colon.
+//
+// All parts are interned, so labels are cheap to copy and to compare for
+// equality.
 class Label {
  public:
   Label();
@@ -42,10 +48,10 @@ class Label {
   bool is_null() const { return dir_.is_null(); }
 
   const SourceDir& dir() const { return dir_; }
-  const std::string& name() const { return name_; }
+  const std::string& name() const { return name_.str(); }
 
   const SourceDir& toolchain_dir() const { return toolchain_dir_; }
-  const std::string& toolchain_name() const { return toolchain_name_; }
+  const std::string& toolchain_name() const { return toolchain_name_.str(); }
 
   // Returns the current label's toolchain as its own Label.
   Label GetToolchainLabel() const;
@@ -71,9 +77,11 @@ class Label {
   }
   bool operator!=(const Label& other) const { return !operator==(other); }
   bool operator<(const Label& other) const {
+    // Compares the strings (not the atoms' identity), so that the order is
+    // deterministic.
     if (int c = dir_.value().compare(other.dir_.value()))
       return c < 0;
-    if (int c = name_.compare(other.name_))
+    if (int c = name_.str().compare(other.name_.str()))
       return c < 0;
     if (int c = toolchain_dir_.value().compare(other.toolchain_dir_.value()))
       return c < 0;
@@ -82,9 +90,16 @@ class Label {
 
   void swap(Label& other) {
     dir_.swap(other.dir_);
-    name_.swap(other.name_);
+    std::swap(name_, other.name_);
     toolchain_dir_.swap(other.toolchain_dir_);
-    toolchain_name_.swap(other.toolchain_name_);
+    std::swap(toolchain_name_, other.toolchain_name_);
+  }
+
+  // Combines the precomputed hashes of the parts.
+  size_t hash() const {
+    return ((dir_.hash() * 131 + name_.hash()) * 131 + toolchain_dir_.hash()) *
+               131 +
+           toolchain_name_.hash();
   }
 
   // Returns true if the toolchain dir/name of this object matches some
@@ -96,23 +111,17 @@ class Label {
 
  private:
   SourceDir dir_;
-  std::string name_;
+  StringAtom name_;
 
   SourceDir toolchain_dir_;
-  std::string toolchain_name_;
+  StringAtom toolchain_name_;
 };
 
 namespace std {
 
 template <>
 struct hash<Label> {
-  std::size_t operator()(const Label& v) const {
-    hash<std::string> stringhash;
-    return ((stringhash(v.dir().value()) * 131 + stringhash(v.name())) * 131 +
-            stringhash(v.toolchain_dir().value())) *
-               131 +
-           stringhash(v.toolchain_name());
-  }
+  std::size_t operator()(const Label& v) const { return v.hash(); }
 };
 
 }  // namespace std
@@ -4,6 +4,49 @@
 
 #include "tools/gn/metadata_walk.h"
 
+MetadataWalkSteps::Step::Step() = default;
+
+MetadataWalkSteps::Step::~Step() = default;
+
+MetadataWalkSteps::MetadataWalkSteps() = default;
+
+MetadataWalkSteps::~MetadataWalkSteps() = default;
+
+const MetadataWalkSteps::Step* MetadataWalkSteps::Find(
+    const Target* target) const {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto found = steps_.find(target);
+  if (found == steps_.end())
+    return nullptr;
+  return found->second.get();
+}
+
+const MetadataWalkSteps::Step* MetadataWalkSteps::Add(
+    const Target* target,
+    std::unique_ptr<Step> step) {
+  std::lock_guard<std::mutex> lock(lock_);
+  std::unique_ptr<Step>& stored = steps_[target];
+  if (!stored)
+    stored = std::move(step);
+  return stored.get();
+}
+
+MetadataWalkCache::MetadataWalkCache() = default;
+
+MetadataWalkCache::~MetadataWalkCache() = default;
+
+MetadataWalkSteps* MetadataWalkCache::GetSteps(
+    const std::vector<std::string>& keys_to_extract,
+    const std::vector<std::string>& keys_to_walk,
+    const SourceDir& rebase_dir) {
+  std::lock_guard<std::mutex> lock(lock_);
+  std::unique_ptr<MetadataWalkSteps>& steps =
+      steps_[Keys(keys_to_extract, keys_to_walk, rebase_dir.value())];
+  if (!steps)
+    steps = std::make_unique<MetadataWalkSteps>();
+  return steps.get();
+}
+
 std::vector<Value> WalkMetadata(
     const UniqueVector<const Target*>& targets_to_walk,
     const std::vector<std::string>& keys_to_extract,
@@ -5,11 +5,79 @@
 #ifndef TOOLS_GN_METADATAWALK_H_
 #define TOOLS_GN_METADATAWALK_H_
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
 #include "tools/gn/build_settings.h"
 #include "tools/gn/target.h"
 #include "tools/gn/unique_vector.h"
 #include "tools/gn/value.h"
 
+// The steps taken at each target by metadata walks with one set of keys,
+// kept so that later walks with the same keys don't collect, rebase and
+// resolve the same metadata again. Only successful steps are added.
+//
+// This class is threadsafe.
+class MetadataWalkSteps {
+ public:
+  struct Step {
+    Step();
+    ~Step();
+
+    // The values collected from the target itself.
+    std::vector<Value> values;
+
+    // The deps to walk next, in order.
+    std::vector<const Target*> next;
+  };
+
+  MetadataWalkSteps();
+  ~MetadataWalkSteps();
+
+  // Returns the step of |target|, or null if there is none yet.
+  const Step* Find(const Target* target) const;
+
+  // Adds the step of |target| and returns the stored one, which is the first
+  // one added if another thread got there first.
+  const Step* Add(const Target* target, std::unique_ptr<Step> step);
+
+ private:
+  mutable std::mutex lock_;
+  std::unordered_map<const Target*, std::unique_ptr<Step>> steps_;
+
+  DISALLOW_COPY_AND_ASSIGN(MetadataWalkSteps);
+};
+
+// The MetadataWalkSteps of every set of keys walked during a run, shared by
+// all generated_file targets (which often collect the same keys over most of
+// the build).
+//
+// This class is threadsafe.
+class MetadataWalkCache {
+ public:
+  MetadataWalkCache();
+  ~MetadataWalkCache();
+
+  MetadataWalkSteps* GetSteps(const std::vector<std::string>& keys_to_extract,
+                              const std::vector<std::string>& keys_to_walk,
+                              const SourceDir& rebase_dir);
+
+ private:
+  using Keys = std::
+      tuple<std::vector<std::string>, std::vector<std::string>, std::string>;
+
+  std::mutex lock_;
+  std::map<Keys, std::unique_ptr<MetadataWalkSteps>> steps_;
+
+  DISALLOW_COPY_AND_ASSIGN(MetadataWalkCache);
+};
+
 // Function to collect metadata from resolved targets listed in targets_walked.
 // Intended to be called after all targets are resolved.
 //
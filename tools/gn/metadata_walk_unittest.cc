@@ -209,3 +209,45 @@ TEST(MetadataWalkTest, CollectWithError) {
             "specified the appropriate toolchain.")
       << err.message();
 }
+
+TEST(MetadataWalkTest, SharedSteps) {
+  TestWithScope setup;
+
+  TestTarget one(setup, "//foo:one", Target::SOURCE_SET);
+  TestTarget two(setup, "//foo:two", Target::SOURCE_SET);
+  TestTarget three(setup, "//foo:three", Target::SOURCE_SET);
+  Value a_expected(nullptr, Value::LIST);
+  a_expected.list_value().push_back(Value(nullptr, "foo"));
+  three.metadata().contents().insert(
+      std::pair<base::StringPiece, Value>("a", a_expected));
+  one.public_deps().push_back(LabelTargetPair(&three));
+  two.public_deps().push_back(LabelTargetPair(&three));
+
+  std::vector<std::string> data_keys;
+  data_keys.push_back("a");
+  std::vector<std::string> walk_keys;
+
+  MetadataWalkCache cache;
+  MetadataWalkSteps* steps = cache.GetSteps(data_keys, walk_keys, SourceDir());
+  EXPECT_EQ(steps, cache.GetSteps(data_keys, walk_keys, SourceDir()));
+  EXPECT_NE(steps, cache.GetSteps(data_keys, walk_keys, SourceDir("//foo/")));
+
+  // The second walk reuses the step taken at three by the first.
+  std::vector<Value> expected;
+  expected.push_back(Value(nullptr, "foo"));
+  for (const Target* target : {&one, &two}) {
+    Err err;
+    std::vector<Value> result;
+    std::set<const Target*> targets_walked;
+    EXPECT_TRUE(target->GetMetadata(data_keys, walk_keys, SourceDir(), true,
+                                    steps, &result, &targets_walked, &err));
+    EXPECT_FALSE(err.has_error());
+    EXPECT_EQ(expected, result);
+    ASSERT_TRUE(steps->Find(&three));
+    EXPECT_EQ(expected, steps->Find(&three)->values);
+  }
+
+  // The top-level targets of deps_only walks are not shared.
+  EXPECT_FALSE(steps->Find(&one));
+  EXPECT_FALSE(steps->Find(&two));
+}
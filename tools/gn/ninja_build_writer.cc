@@ -8,7 +8,8 @@
 
 #include <fstream>
 #include <map>
-#include <sstream>
+#include <memory>
+#include <ostream>
 #include <unordered_set>
 
 #include "base/command_line.h"
@@ -25,6 +26,7 @@
 #include "tools/gn/ninja_utils.h"
 #include "tools/gn/pool.h"
 #include "tools/gn/scheduler.h"
+#include "tools/gn/string_output_buffer.h"
 #include "tools/gn/switches.h"
 #include "tools/gn/target.h"
 #include "tools/gn/trace.h"
@@ -204,6 +206,14 @@ NinjaBuildWriter::NinjaBuildWriter(
 
 NinjaBuildWriter::~NinjaBuildWriter() = default;
 
+void NinjaBuildWriter::SetPhonyShards(
+    const std::vector<std::ostream*>& shards,
+    const std::vector<SourceFile>& shard_files) {
+  DCHECK(shards.size() == shard_files.size());
+  phony_shards_ = shards;
+  phony_shard_files_ = shard_files;
+}
+
 bool NinjaBuildWriter::Run(Err* err) {
   WriteNinjaRules();
   WriteAllPools();
@@ -244,34 +254,53 @@ bool NinjaBuildWriter::RunAndWriteFile(const BuildSettings* build_settings,
     }
   }
 
-  std::stringstream file;
-  std::stringstream depfile;
+  StringOutputBuffer storage;
+  std::ostream file(&storage);
+  StringOutputBuffer dep_storage;
+  std::ostream depfile(&dep_storage);
   NinjaBuildWriter gen(build_settings, used_toolchains, all_targets,
                        default_toolchain, default_toolchain_targets,
                        file, depfile);
+
+  size_t shard_count = build_settings->ninja_shard_count();
+  std::vector<std::unique_ptr<StringOutputBuffer>> shard_storage;
+  std::vector<std::unique_ptr<std::ostream>> shard_streams;
+  std::vector<SourceFile> shard_files;
+  if (shard_count > 1) {
+    std::vector<std::ostream*> shards;
+    for (size_t i = 0; i < shard_count; i++) {
+      shard_storage.emplace_back(new StringOutputBuffer);
+      shard_streams.emplace_back(new std::ostream(shard_storage.back().get()));
+      shards.push_back(shard_streams.back().get());
+      shard_files.push_back(GetNinjaShardFile(
+          SourceFile(build_settings->build_dir().value() + "build.ninja"), i));
+    }
+    gen.SetPhonyShards(shards, shard_files);
+  }
+
   if (!gen.Run(err))
     return false;
 
+  // Only rewrite the shards that changed.
+  for (size_t i = 0; i < shard_storage.size(); i++) {
+    if (!shard_storage[i]->WriteToFileIfChanged(
+            build_settings->GetFullPath(shard_files[i]), err))
+      return false;
+  }
+
   // Unconditionally write the build.ninja. Ninja's build-out-of-date checking
   // will re-run GN when any build input is newer than build.ninja, so any time
   // the build is updated, build.ninja's timestamp needs to updated also, even
   // if the contents haven't been changed.
   base::FilePath ninja_file_name(build_settings->GetFullPath(
       SourceFile(build_settings->build_dir().value() + "build.ninja")));
-  base::CreateDirectory(ninja_file_name.DirName());
-  std::string ninja_contents = file.str();
-  if (base::WriteFile(ninja_file_name, ninja_contents.data(),
-                      static_cast<int>(ninja_contents.size())) !=
-      static_cast<int>(ninja_contents.size()))
+  if (!storage.WriteToFile(ninja_file_name, err))
     return false;
 
   // Dep file listing build dependencies.
   base::FilePath dep_file_name(build_settings->GetFullPath(
       SourceFile(build_settings->build_dir().value() + "build.ninja.d")));
-  std::string dep_contents = depfile.str();
-  if (base::WriteFile(dep_file_name, dep_contents.data(),
-                      static_cast<int>(dep_contents.size())) !=
-      static_cast<int>(dep_contents.size()))
+  if (!dep_storage.WriteToFile(dep_file_name, err))
     return false;
 
   return true;
@@ -581,6 +610,14 @@ bool NinjaBuildWriter::WritePhonyAndAllRules(Err* err) {
     }
   }
 
+  // The shards must be loaded before the "default" statements below, which may
+  // refer to their rules.
+  for (const SourceFile& shard_file : phony_shard_files_) {
+    out_ << "subninja ";
+    path_output_.WriteFile(out_, shard_file);
+    out_ << std::endl;
+  }
+
   // Write the autogenerated "all" rule.
   if (!default_toolchain_targets_.empty()) {
     out_ << "\nbuild all: phony";
@@ -618,7 +655,12 @@ void NinjaBuildWriter::WritePhonyRule(const Target* target,
   // Escape for special chars Ninja will handle.
   std::string escaped = EscapeString(phony_name, ninja_escape, nullptr);
 
-  out_ << "build " << escaped << ": phony ";
-  path_output_.WriteFile(out_, target->dependency_output_file());
-  out_ << std::endl;
+  std::ostream& out =
+      phony_shards_.empty()
+          ? out_
+          : *phony_shards_[GetNinjaShardForTarget(target,
+                                                  phony_shards_.size())];
+  out << "build " << escaped << ": phony ";
+  path_output_.WriteFile(out, target->dependency_output_file());
+  out << std::endl;
 }
@@ -12,6 +12,7 @@
 
 #include "base/macros.h"
 #include "tools/gn/path_output.h"
+#include "tools/gn/source_file.h"
 
 class Builder;
 class BuildSettings;
@@ -48,6 +49,12 @@ class NinjaBuildWriter {
                               const Builder& builder,
                               Err* err);
 
+  // Writes the phony rules of each target to one of the given streams instead
+  // of the main file, picked by GetNinjaShardForTarget(). The main file loads
+  // the shards with subninja, |shard_files| being their names.
+  void SetPhonyShards(const std::vector<std::ostream*>& shards,
+                      const std::vector<SourceFile>& shard_files);
+
   bool Run(Err* err);
 
  private:
@@ -69,6 +76,10 @@ class NinjaBuildWriter {
   std::ostream& dep_out_;
   PathOutput path_output_;
 
+  // Empty unless the phony rules are sharded.
+  std::vector<std::ostream*> phony_shards_;
+  std::vector<SourceFile> phony_shard_files_;
+
   DISALLOW_COPY_AND_ASSIGN(NinjaBuildWriter);
 };
 
@@ -7,6 +7,7 @@
 #include "base/command_line.h"
 #include "base/files/file_util.h"
 #include "tools/gn/ninja_build_writer.h"
+#include "tools/gn/ninja_utils.h"
 #include "tools/gn/pool.h"
 #include "tools/gn/scheduler.h"
 #include "tools/gn/switches.h"
@@ -196,6 +197,70 @@ TEST_F(NinjaBuildWriterTest, TwoTargets) {
   EXPECT_EQ(std::string::npos, out_str.find("pool console"));
 }
 
+TEST_F(NinjaBuildWriterTest, PhonyShards) {
+  TestWithScope setup;
+  Err err;
+
+  base::FilePath gn(FILE_PATH_LITERAL("testdot.gn"));
+  ScopedDotGNFile dot_gn(gn);
+  base::FilePath gn_realpath = base::MakeAbsoluteFilePath(gn);
+  setup.build_settings()->SetRootPath(
+      base::MakeAbsoluteFilePath(base::FilePath(FILE_PATH_LITERAL("."))));
+  setup.build_settings()->SetDotFilePath(gn_realpath);
+  setup.build_settings()->set_dotfile_name(gn_realpath);
+
+  Target target_foo(setup.settings(), Label(SourceDir("//foo/"), "bar"));
+  target_foo.set_output_type(Target::ACTION);
+  target_foo.action_values().set_script(SourceFile("//foo/script.py"));
+  target_foo.action_values().outputs() =
+      SubstitutionList::MakeForTest("//out/Debug/out1.out");
+  ASSERT_TRUE(target_foo.OnResolved(&err));
+
+  Target target_bar(setup.settings(), Label(SourceDir("//bar/"), "bar"));
+  target_bar.set_output_type(Target::ACTION);
+  target_bar.action_values().set_script(SourceFile("//bar/script.py"));
+  target_bar.action_values().outputs() =
+      SubstitutionList::MakeForTest("//out/Debug/out2.out");
+  ASSERT_TRUE(target_bar.OnResolved(&err));
+
+  std::unordered_map<const Settings*, const Toolchain*> used_toolchains;
+  used_toolchains[setup.settings()] = setup.toolchain();
+  std::vector<const Target*> targets = {&target_foo, &target_bar};
+
+  std::ostringstream ninja_out;
+  std::ostringstream depfile_out;
+  std::ostringstream shard_out[2];
+  NinjaBuildWriter writer(setup.build_settings(), used_toolchains, targets,
+                          setup.toolchain(), targets, ninja_out, depfile_out);
+  writer.SetPhonyShards(
+      {&shard_out[0], &shard_out[1]},
+      {SourceFile("//out/Debug/build.0.ninja"),
+       SourceFile("//out/Debug/build.1.ninja")});
+  ASSERT_TRUE(writer.Run(&err));
+
+  // The main file loads the shards before the "default" statement, and keeps
+  // the "all" rule.
+  std::string out_str = ninja_out.str();
+  size_t subninjas =
+      out_str.find("subninja build.0.ninja\nsubninja build.1.ninja\n");
+  ASSERT_NE(std::string::npos, subninjas);
+  EXPECT_LT(subninjas, out_str.find("\ndefault all\n"));
+  EXPECT_NE(std::string::npos, out_str.find("build all: phony"));
+  EXPECT_EQ(std::string::npos, out_str.find("build bar: phony"));
+
+  // Each target's rules are all in its shard.
+  std::string foo_shard =
+      shard_out[GetNinjaShardForTarget(&target_foo, 2)].str();
+  std::string bar_shard =
+      shard_out[GetNinjaShardForTarget(&target_bar, 2)].str();
+  EXPECT_NE(std::string::npos,
+            foo_shard.find("build foo$:bar: phony obj/foo/bar.stamp\n"));
+  EXPECT_NE(std::string::npos,
+            bar_shard.find("build bar: phony obj/bar/bar.stamp\n"));
+  EXPECT_NE(std::string::npos,
+            bar_shard.find("build bar$:bar: phony obj/bar/bar.stamp\n"));
+}
+
 TEST_F(NinjaBuildWriterTest, DuplicateOutputs) {
   TestWithScope setup;
   Err err;
@@ -4,13 +4,17 @@
 
 #include "tools/gn/ninja_generated_file_target_writer.h"
 
+#include <ostream>
+
 #include "base/strings/string_util.h"
 #include "tools/gn/deps_iterator.h"
 #include "tools/gn/filesystem_utils.h"
+#include "tools/gn/metadata_walk.h"
 #include "tools/gn/output_conversion.h"
 #include "tools/gn/output_file.h"
 #include "tools/gn/scheduler.h"
 #include "tools/gn/settings.h"
+#include "tools/gn/string_output_buffer.h"
 #include "tools/gn/string_utils.h"
 #include "tools/gn/target.h"
 #include "tools/gn/trace.h"
@@ -53,9 +57,13 @@ void NinjaGeneratedFileTargetWriter::GenerateFile() {
     CHECK(target_->action_values().outputs().list().size() == 1U);
     contents = Value(target_->action_values().outputs().list()[0].origin(),
                      Value::LIST);
+    // Other generated_file targets often walk the same keys, so share the
+    // steps at each dependency with them.
+    MetadataWalkSteps* steps = g_scheduler->metadata_walk_cache()->GetSteps(
+        target_->data_keys(), target_->walk_keys(), target_->rebase());
     std::set<const Target*> targets_walked;
     if (!target_->GetMetadata(target_->data_keys(), target_->walk_keys(),
-                              target_->rebase(), /*deps_only = */ true,
+                              target_->rebase(), /*deps_only = */ true, steps,
                               &contents.list_value(), &targets_walked, &err)) {
       g_scheduler->FailWithError(err);
       return;
@@ -74,7 +82,8 @@ void NinjaGeneratedFileTargetWriter::GenerateFile() {
   ScopedTrace trace(TraceItem::TRACE_FILE_WRITE, outputs_as_sources[0].value());
 
   // Compute output.
-  std::ostringstream out;
+  StringOutputBuffer storage;
+  std::ostream out(&storage);
   ConvertValueToOutput(settings_, contents, target_->output_conversion(), out,
                        &err);
 
@@ -83,7 +92,7 @@ void NinjaGeneratedFileTargetWriter::GenerateFile() {
     return;
   }
 
-  WriteFileIfChanged(output, out.str(), &err);
+  storage.WriteToFileIfChanged(output, &err);
 
   if (err.has_error()) {
     g_scheduler->FailWithError(err);
@@ -0,0 +1,351 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/ninja_target_cache.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/files/file_util.h"
+#include "tools/gn/build_settings.h"
+#include "tools/gn/cache_file.h"
+#include "tools/gn/config.h"
+#include "tools/gn/deps_iterator.h"
+#include "tools/gn/filesystem_utils.h"
+#include "tools/gn/input_file.h"
+#include "tools/gn/input_file_manager.h"
+#include "tools/gn/item.h"
+#include "tools/gn/last_commit_position.h"
+#include "tools/gn/loader.h"
+#include "tools/gn/ninja_utils.h"
+#include "tools/gn/parse_tree.h"
+#include "tools/gn/scheduler.h"
+#include "tools/gn/target.h"
+#include "tools/gn/toolchain.h"
+
+namespace {
+
+const char kNinjaTargetCacheMagic[] = "GNTC";
+
+// Increment when the fingerprint computation or the file layout changes.
+const uint32_t kNinjaTargetCacheVersion = 1;
+
+bool DigestsEqual(const base::MD5Digest& a, const base::MD5Digest& b) {
+  return memcmp(a.a, b.a, sizeof(a.a)) == 0;
+}
+
+void UpdateWithString(base::MD5Context* context, const std::string& str) {
+  // Include the terminator so that adjacent strings can't run together.
+  base::MD5Update(context, base::StringPiece(str.c_str(), str.size() + 1));
+}
+
+void UpdateWithDigest(base::MD5Context* context,
+                      const base::MD5Digest& digest) {
+  base::MD5Update(context,
+                  base::StringPiece(reinterpret_cast<const char*>(digest.a),
+                                    sizeof(digest.a)));
+}
+
+// Adds the path and contents digest of the given file, if it exists.
+void UpdateWithFile(base::MD5Context* context, const base::FilePath& path) {
+  UpdateWithString(context, FilePathToUTF8(path));
+  FileStamp stamp;
+  if (GetFileStamp(path, &stamp))
+    UpdateWithDigest(context, stamp.digest);
+  else
+    UpdateWithString(context, "<missing>");
+}
+
+}  // namespace
+
+NinjaTargetCache::Entry::Entry() : used(false) {}
+
+NinjaTargetCache::Entry::~Entry() = default;
+
+NinjaTargetCache::NinjaTargetCache(const BuildSettings* build_settings,
+                                   const base::FilePath& cache_file)
+    : build_settings_(build_settings),
+      cache_file_(cache_file),
+      loaded_(false),
+      gen_dependencies_computed_(false) {
+  memset(environment_.a, 0, sizeof(environment_.a));
+  memset(gen_dependencies_.a, 0, sizeof(gen_dependencies_.a));
+}
+
+NinjaTargetCache::~NinjaTargetCache() = default;
+
+void NinjaTargetCache::Load() {
+  environment_ = ComputeEnvironmentDigest();
+
+  std::string body;
+  if (!ReadCacheFile(cache_file_, kNinjaTargetCacheMagic,
+                     kNinjaTargetCacheVersion, &body))
+    return;
+
+  CacheReader reader(body);
+  base::MD5Digest environment;
+  base::MD5Digest gen_dependencies;
+  uint64_t count;
+  if (!reader.ReadDigest(&environment) ||
+      !DigestsEqual(environment, environment_) ||
+      !reader.ReadDigest(&gen_dependencies) || !reader.ReadVarint(&count))
+    return;
+
+  std::unordered_map<std::string, Entry> entries;
+  for (uint64_t i = 0; i < count; i++) {
+    base::StringPiece label;
+    base::StringPiece rule;
+    Entry entry;
+    if (!reader.ReadString(&label) || !reader.ReadDigest(&entry.fingerprint) ||
+        !reader.ReadString(&rule))
+      return;  // Corrupt, ignore the whole file.
+    entry.rule = rule.as_string();
+    entries[label.as_string()] = std::move(entry);
+  }
+  if (!reader.at_end())
+    return;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_ = std::move(entries);
+  gen_dependencies_ = gen_dependencies;
+  loaded_ = true;
+}
+
+bool NinjaTargetCache::Save() {
+  if (!gen_dependencies_computed_)
+    GenDependenciesChanged();
+
+  CacheWriter writer;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    writer.WriteDigest(environment_);
+    writer.WriteDigest(gen_dependencies_);
+
+    // Sort for a deterministic file.
+    std::vector<const std::pair<const std::string, Entry>*> used;
+    for (const auto& pair : entries_) {
+      if (pair.second.used)
+        used.push_back(&pair);
+    }
+    std::sort(used.begin(), used.end(),
+              [](const std::pair<const std::string, Entry>* a,
+                 const std::pair<const std::string, Entry>* b) {
+                return a->first < b->first;
+              });
+
+    writer.WriteVarint(used.size());
+    for (const auto* pair : used) {
+      writer.WriteString(pair->first);
+      writer.WriteDigest(pair->second.fingerprint);
+      writer.WriteString(pair->second.rule);
+    }
+  }
+  return WriteCacheFile(cache_file_, kNinjaTargetCacheMagic,
+                        kNinjaTargetCacheVersion, writer);
+}
+
+bool NinjaTargetCache::Lookup(const Target* target, std::string* rule) {
+  // Generated files are written as a side effect of the ninja writer, so
+  // always run it for them.
+  if (target->output_type() == Target::GENERATED_FILE)
+    return false;
+
+  base::MD5Digest fingerprint;
+  if (!GetFingerprint(target, &fingerprint))
+    return false;
+
+  std::string label = target->label().GetUserVisibleName(true);
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = entries_.find(label);
+    if (found == entries_.end() ||
+        !DigestsEqual(found->second.fingerprint, fingerprint))
+      return false;
+    *rule = found->second.rule;
+  }
+
+  // Binary targets get their own .ninja file which could have been deleted.
+  if (target->IsBinary() &&
+      !base::PathExists(
+          build_settings_->GetFullPath(GetNinjaFileForTarget(target))))
+    return false;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_[label].used = true;
+  cached_targets_.push_back(target);
+  return true;
+}
+
+void NinjaTargetCache::Add(const Target* target, const std::string& rule) {
+  if (target->output_type() == Target::GENERATED_FILE)
+    return;
+
+  Entry entry;
+  if (!GetFingerprint(target, &entry.fingerprint))
+    return;
+  entry.rule = rule;
+  entry.used = true;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_[target->label().GetUserVisibleName(true)] = std::move(entry);
+}
+
+bool NinjaTargetCache::GenDependenciesChanged() {
+  base::MD5Digest gen_dependencies = ComputeGenDependenciesDigest();
+
+  std::lock_guard<std::mutex> lock(lock_);
+  bool changed =
+      !loaded_ || !DigestsEqual(gen_dependencies, gen_dependencies_);
+  gen_dependencies_ = gen_dependencies;
+  gen_dependencies_computed_ = true;
+  return changed;
+}
+
+std::vector<const Target*> NinjaTargetCache::GetCachedTargets() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return cached_targets_;
+}
+
+base::MD5Digest NinjaTargetCache::ComputeEnvironmentDigest() const {
+  base::MD5Context context;
+  base::MD5Init(&context);
+  UpdateWithString(&context, LAST_COMMIT_POSITION);
+  UpdateWithString(&context, FilePathToUTF8(build_settings_->root_path()));
+  UpdateWithString(&context, build_settings_->build_dir().value());
+  UpdateWithString(&context, FilePathToUTF8(build_settings_->python_path()));
+  UpdateWithFile(&context, build_settings_->dotfile_path());
+  UpdateWithFile(&context, build_settings_->GetFullPath(
+                               build_settings_->build_config_file()));
+
+  // At this point this is the args file.
+  for (const base::FilePath& path : g_scheduler->GetGenDependencies())
+    UpdateWithFile(&context, path);
+
+  base::MD5Digest digest;
+  base::MD5Final(&digest, &context);
+  return digest;
+}
+
+base::MD5Digest NinjaTargetCache::ComputeGenDependenciesDigest() const {
+  std::vector<base::FilePath> files = g_scheduler->GetGenDependencies();
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+
+  base::MD5Context context;
+  base::MD5Init(&context);
+  for (const base::FilePath& path : files)
+    UpdateWithFile(&context, path);
+
+  base::MD5Digest digest;
+  base::MD5Final(&digest, &context);
+  return digest;
+}
+
+bool NinjaTargetCache::GetFingerprint(const Item* item,
+                                      base::MD5Digest* fingerprint) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = item_fingerprints_.find(item);
+    if (found != item_fingerprints_.end()) {
+      *fingerprint = found->second.second;
+      return found->second.first;
+    }
+  }
+
+  // Collect the fingerprints of the items this one depends on. Computed
+  // outside the lock; another thread may duplicate the work but will get the
+  // same result.
+  std::vector<const Item*> dependencies;
+  if (const Target* target = item->AsTarget()) {
+    for (const auto& pair : target->GetDeps(Target::DEPS_ALL))
+      dependencies.push_back(pair.ptr);
+    for (const auto* configs :
+         {&target->configs(), &target->all_dependent_configs(),
+          &target->public_configs(), &target->reverse_configs(),
+          &target->all_dependent_reverse_configs(),
+          &target->public_reverse_configs()}) {
+      for (const auto& pair : *configs)
+        dependencies.push_back(pair.ptr);
+    }
+    dependencies.push_back(target->toolchain());
+  } else if (const Config* config = item->AsConfig()) {
+    for (const auto& pair : config->configs())
+      dependencies.push_back(pair.ptr);
+  } else if (const Toolchain* toolchain = item->AsToolchain()) {
+    for (const auto& pair : toolchain->deps())
+      dependencies.push_back(pair.ptr);
+  }
+
+  base::MD5Context context;
+  base::MD5Init(&context);
+  UpdateWithString(&context, item->label().GetUserVisibleName(true));
+
+  bool ok = true;
+  const InputFile* defined_in =
+      item->defined_from() ? item->defined_from()->GetRange().begin().file()
+                           : nullptr;
+  base::MD5Digest digest;
+  if (defined_in && GetFileDigest(defined_in, &digest)) {
+    UpdateWithString(&context, defined_in->name().value());
+    UpdateWithDigest(&context, digest);
+  } else {
+    ok = false;
+  }
+
+  // Items defined by templates have the template's file as |defined_in|, so
+  // always include the build file for the item's directory, which is where
+  // the template was invoked.
+  std::vector<SourceFile> files;
+  files.push_back(Loader::BuildFileForLabel(item->label()));
+  files.insert(files.end(), item->build_dependency_files().begin(),
+               item->build_dependency_files().end());
+
+  InputFileManager* input_file_manager = g_scheduler->input_file_manager();
+  for (const SourceFile& file : files) {
+    const InputFile* input = input_file_manager->GetLoadedFile(file);
+    if (!ok || !input || !GetFileDigest(input, &digest)) {
+      ok = false;
+      break;
+    }
+    UpdateWithString(&context, file.value());
+    UpdateWithDigest(&context, digest);
+  }
+
+  for (const Item* dependency : dependencies) {
+    if (!ok || !dependency || !GetFingerprint(dependency, &digest)) {
+      ok = false;
+      break;
+    }
+    UpdateWithDigest(&context, digest);
+  }
+
+  base::MD5Final(fingerprint, &context);
+
+  std::lock_guard<std::mutex> lock(lock_);
+  item_fingerprints_[item] = std::make_pair(ok, *fingerprint);
+  return ok;
+}
+
+bool NinjaTargetCache::GetFileDigest(const InputFile* file,
+                                     base::MD5Digest* digest) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = file_digests_.find(file);
+    if (found != file_digests_.end()) {
+      *digest = found->second;
+      return true;
+    }
+  }
+
+  // Only dynamic inputs have no name, and those aren't build files.
+  if (file->name().is_null())
+    return false;
+  base::MD5Sum(file->contents().data(), file->contents().size(), digest);
+
+  std::lock_guard<std::mutex> lock(lock_);
+  file_digests_[file] = *digest;
+  return true;
+}
@@ -0,0 +1,119 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_NINJA_TARGET_CACHE_H_
+#define TOOLS_GN_NINJA_TARGET_CACHE_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/md5.h"
+
+class BuildSettings;
+class InputFile;
+class Item;
+class SourceFile;
+class Target;
+
+// Remembers the result of NinjaTargetWriter::RunAndWriteFile() for each target
+// between runs of "gn gen --incremental" so that targets whose inputs didn't
+// change don't have to be written again.
+//
+// Each target gets a fingerprint computed from its label, the contents of the
+// build files it was defined from (including imports), and the fingerprints
+// of its dependencies, configs and toolchain. The cache as a whole is only
+// used when the GN version, the build settings, the .gn file, the build config
+// file and the args file are unchanged.
+//
+// Other files read while running the build files (exec_script and read_file)
+// are only known once loading is done. They are checked afterwards with
+// GenDependenciesChanged(), and if any of them changed, the cached targets
+// must be written again.
+//
+// This class is threadsafe.
+class NinjaTargetCache {
+ public:
+  NinjaTargetCache(const BuildSettings* build_settings,
+                   const base::FilePath& cache_file);
+  ~NinjaTargetCache();
+
+  // Reads the cache file written by the previous run. Must be called before
+  // loading starts, after the args file is known.
+  void Load();
+
+  // Writes the entries for the targets of this run to the cache file.
+  bool Save();
+
+  // Fills |rule| with the rule that the previous run got for |target| if its
+  // fingerprint is unchanged and the files it wrote still exist. The target
+  // must be resolved.
+  bool Lookup(const Target* target, std::string* rule);
+
+  // Records the result of writing |target|.
+  void Add(const Target* target, const std::string& rule);
+
+  // Returns true if any of the files read by exec_script or read_file (see
+  // Scheduler::GetGenDependencies()) differ from the previous run. Must be
+  // called once loading is complete.
+  bool GenDependenciesChanged();
+
+  // Returns the targets for which Lookup() succeeded.
+  std::vector<const Target*> GetCachedTargets() const;
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    base::MD5Digest fingerprint;
+    std::string rule;
+    bool used;
+  };
+
+  // Computes the digest of the GN version, build settings and the files
+  // known before loading.
+  base::MD5Digest ComputeEnvironmentDigest() const;
+
+  // Computes the digest of all files in Scheduler::GetGenDependencies().
+  base::MD5Digest ComputeGenDependenciesDigest() const;
+
+  // Returns false if the item can't be fingerprinted, e.g. because one of its
+  // build files isn't known to the InputFileManager.
+  bool GetFingerprint(const Item* item, base::MD5Digest* fingerprint);
+  bool GetFileDigest(const InputFile* file, base::MD5Digest* digest);
+
+  const BuildSettings* build_settings_;
+  base::FilePath cache_file_;
+
+  mutable std::mutex lock_;
+
+  base::MD5Digest environment_;
+  base::MD5Digest gen_dependencies_;
+
+  // Set by Load() when the previous run had the same environment.
+  bool loaded_;
+
+  // Set by GenDependenciesChanged().
+  bool gen_dependencies_computed_;
+
+  // Keyed by the label of the target including the toolchain.
+  std::unordered_map<std::string, Entry> entries_;
+
+  std::vector<const Target*> cached_targets_;
+
+  // Memoized item fingerprints. A false value means the item can't be
+  // fingerprinted.
+  std::map<const Item*, std::pair<bool, base::MD5Digest>> item_fingerprints_;
+  std::map<const InputFile*, base::MD5Digest> file_digests_;
+
+  DISALLOW_COPY_AND_ASSIGN(NinjaTargetCache);
+};
+
+#endif  // TOOLS_GN_NINJA_TARGET_CACHE_H_
@@ -0,0 +1,225 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "tools/gn/ninja_target_cache.h"
+#include "tools/gn/parse_tree.h"
+#include "tools/gn/scheduler.h"
+#include "tools/gn/target.h"
+#include "tools/gn/test_with_scheduler.h"
+#include "tools/gn/test_with_scope.h"
+#include "util/msg_loop.h"
+#include "util/test/test.h"
+
+namespace {
+
+class NinjaTargetCacheTest : public TestWithScheduler {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    setup_.build_settings()->SetRootPath(temp_dir_.GetPath());
+    cache_file_ = temp_dir_.GetPath().AppendASCII("gn_targets.cache");
+
+    // Items are fingerprinted by the build files they come from, so those
+    // must be loaded through the InputFileManager.
+    setup_.toolchain()->set_defined_from(LoadBuildFile("toolchain"));
+    foo_build_file_ = LoadBuildFile("foo");
+  }
+
+  const ParseNode* LoadBuildFile(const std::string& dir) {
+    base::FilePath dir_path = temp_dir_.GetPath().AppendASCII(dir);
+    base::CreateDirectory(dir_path);
+    std::string contents = "dir = \"" + dir + "\"\n";
+    base::WriteFile(dir_path.AppendASCII("BUILD.gn"), contents.c_str(),
+                    static_cast<int>(contents.size()));
+
+    Err err;
+    const ParseNode* root = scheduler().input_file_manager()->SyncLoadFile(
+        LocationRange(), setup_.build_settings(),
+        SourceFile("//" + dir + "/BUILD.gn"), &err);
+    EXPECT_FALSE(err.has_error());
+
+    // Like a target definition, return a node inside of the file.
+    return root->AsBlock()->statements()[0].get();
+  }
+
+  // Makes a resolved group in //foo.
+  std::unique_ptr<Target> MakeGroup(const std::string& name) {
+    auto target = std::make_unique<Target>(
+        setup_.settings(), Label(SourceDir("//foo/"), name));
+    target->set_output_type(Target::GROUP);
+    target->set_defined_from(foo_build_file_);
+    target->visibility().SetPublic();
+    return target;
+  }
+
+  TestWithScope setup_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath cache_file_;
+  const ParseNode* foo_build_file_ = nullptr;
+};
+
+// Runs the cache like consecutive runs of "gn gen --incremental", each with
+// its own Scheduler so that files are loaded again.
+class NinjaTargetCacheRunTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    WriteSourceFile("toolchain/BUILD.gn", "toolchain = 1\n");
+    WriteSourceFile("foo/BUILD.gn", "foo = 1\n");
+    WriteSourceFile("foo/dep.gni", "dep = 1\n");
+    WriteSourceFile("bar/BUILD.gn", "bar = 1\n");
+  }
+
+  void WriteSourceFile(const std::string& name, const std::string& contents) {
+    base::FilePath path = temp_dir_.GetPath().AppendASCII(name);
+    base::CreateDirectory(path.DirName());
+    base::WriteFile(path, contents.c_str(), static_cast<int>(contents.size()));
+  }
+
+  // Like one run of "gn gen": makes //foo:a, which depends on //bar:b and
+  // lists //foo/dep.gni in its build_dependency_files, and returns whether the
+  // cache had an entry for //foo:a. Then saves the cache with entries for both.
+  bool RunGen() {
+    Scheduler scheduler;
+    TestWithScope setup;
+    setup.build_settings()->SetRootPath(temp_dir_.GetPath());
+    setup.toolchain()->set_defined_from(
+        LoadFile(&setup, "//toolchain/BUILD.gn"));
+
+    Err err;
+    Target b(setup.settings(), Label(SourceDir("//bar/"), "b"));
+    b.set_output_type(Target::GROUP);
+    b.set_defined_from(LoadFile(&setup, "//bar/BUILD.gn"));
+    b.visibility().SetPublic();
+    EXPECT_TRUE(b.OnResolved(&err));
+
+    Target a(setup.settings(), Label(SourceDir("//foo/"), "a"));
+    a.set_output_type(Target::GROUP);
+    a.set_defined_from(LoadFile(&setup, "//foo/BUILD.gn"));
+    LoadFile(&setup, "//foo/dep.gni");
+    a.build_dependency_files().insert(SourceFile("//foo/dep.gni"));
+    a.public_deps().push_back(LabelTargetPair(&b));
+    EXPECT_TRUE(a.OnResolved(&err));
+
+    NinjaTargetCache cache(setup.build_settings(),
+                           temp_dir_.GetPath().AppendASCII("gn_targets.cache"));
+    cache.Load();
+    std::string rule;
+    bool found = cache.Lookup(&a, &rule);
+    cache.Add(&a, "build a: phony\n");
+    cache.Add(&b, "build b: phony\n");
+    EXPECT_TRUE(cache.Save());
+    return found;
+  }
+
+  const ParseNode* LoadFile(TestWithScope* setup, const std::string& name) {
+    Err err;
+    const ParseNode* root = g_scheduler->input_file_manager()->SyncLoadFile(
+        LocationRange(), setup->build_settings(), SourceFile(name), &err);
+    EXPECT_FALSE(err.has_error());
+    return root->AsBlock()->statements()[0].get();
+  }
+
+  MsgLoop msg_loop_;
+  base::ScopedTempDir temp_dir_;
+};
+
+}  // namespace
+
+TEST_F(NinjaTargetCacheTest, LookupAfterSave) {
+  Err err;
+  std::unique_ptr<Target> a = MakeGroup("a");
+  ASSERT_TRUE(a->OnResolved(&err));
+
+  // Nothing cached on the first run.
+  {
+    NinjaTargetCache cache(setup_.build_settings(), cache_file_);
+    cache.Load();
+    std::string rule;
+    EXPECT_FALSE(cache.Lookup(a.get(), &rule));
+    cache.Add(a.get(), "build a: phony\n");
+    EXPECT_TRUE(cache.Save());
+  }
+
+  // The second run gets the rule back.
+  {
+    NinjaTargetCache cache(setup_.build_settings(), cache_file_);
+    cache.Load();
+    std::string rule;
+    EXPECT_TRUE(cache.Lookup(a.get(), &rule));
+    EXPECT_EQ("build a: phony\n", rule);
+    EXPECT_FALSE(cache.GenDependenciesChanged());
+    ASSERT_EQ(1u, cache.GetCachedTargets().size());
+    EXPECT_EQ(a.get(), cache.GetCachedTargets()[0]);
+    EXPECT_TRUE(cache.Save());
+  }
+
+  // Adding a dependency changes the fingerprint.
+  std::unique_ptr<Target> b = MakeGroup("b");
+  ASSERT_TRUE(b->OnResolved(&err));
+  std::unique_ptr<Target> a_with_dep = MakeGroup("a");
+  a_with_dep->public_deps().push_back(LabelTargetPair(b.get()));
+  ASSERT_TRUE(a_with_dep->OnResolved(&err));
+  {
+    NinjaTargetCache cache(setup_.build_settings(), cache_file_);
+    cache.Load();
+    std::string rule;
+    EXPECT_FALSE(cache.Lookup(a_with_dep.get(), &rule));
+    EXPECT_TRUE(cache.GetCachedTargets().empty());
+  }
+}
+
+TEST_F(NinjaTargetCacheTest, UnknownBuildFile) {
+  Err err;
+
+  // Not defined from a file the InputFileManager knows about, so it can't be
+  // cached.
+  Target target(setup_.settings(), Label(SourceDir("//bar/"), "bar"));
+  target.set_output_type(Target::GROUP);
+  target.set_defined_from(foo_build_file_);
+  target.visibility().SetPublic();
+  ASSERT_TRUE(target.OnResolved(&err));
+
+  NinjaTargetCache cache(setup_.build_settings(), cache_file_);
+  cache.Load();
+  cache.Add(&target, "build bar: phony\n");
+  EXPECT_TRUE(cache.Save());
+
+  NinjaTargetCache second_cache(setup_.build_settings(), cache_file_);
+  second_cache.Load();
+  std::string rule;
+  EXPECT_FALSE(second_cache.Lookup(&target, &rule));
+}
+
+TEST_F(NinjaTargetCacheRunTest, BuildFileChanged) {
+  EXPECT_FALSE(RunGen());
+  EXPECT_TRUE(RunGen());
+
+  WriteSourceFile("foo/BUILD.gn", "foo = 2\n");
+  EXPECT_FALSE(RunGen());
+  EXPECT_TRUE(RunGen());
+}
+
+TEST_F(NinjaTargetCacheRunTest, DependencyChanged) {
+  EXPECT_FALSE(RunGen());
+  EXPECT_TRUE(RunGen());
+
+  // Changes the fingerprint of //bar:b.
+  WriteSourceFile("bar/BUILD.gn", "bar = 2\n");
+  EXPECT_FALSE(RunGen());
+  EXPECT_TRUE(RunGen());
+}
+
+TEST_F(NinjaTargetCacheRunTest, BuildDependencyFileChanged) {
+  EXPECT_FALSE(RunGen());
+  EXPECT_TRUE(RunGen());
+
+  WriteSourceFile("foo/dep.gni", "dep = 2\n");
+  EXPECT_FALSE(RunGen());
+  EXPECT_TRUE(RunGen());
+}
@@ -4,7 +4,7 @@
 
 #include "tools/gn/ninja_target_writer.h"
 
-#include <sstream>
+#include <ostream>
 
 #include "base/files/file_util.h"
 #include "base/strings/string_util.h"
@@ -22,6 +22,7 @@
 #include "tools/gn/ninja_utils.h"
 #include "tools/gn/output_file.h"
 #include "tools/gn/scheduler.h"
+#include "tools/gn/string_output_buffer.h"
 #include "tools/gn/string_utils.h"
 #include "tools/gn/substitution_writer.h"
 #include "tools/gn/target.h"
@@ -48,9 +49,10 @@ std::string NinjaTargetWriter::RunAndWriteFile(const Target* target) {
   if (g_scheduler->verbose_logging())
     g_scheduler->Log("Computing", target->label().GetUserVisibleName(true));
 
-  // It's ridiculously faster to write to a string and then write that to
-  // disk in one operation than to use an fstream here.
-  std::stringstream rules;
+  // It's ridiculously faster to write to memory and then write that to disk
+  // in one operation than to use an fstream here.
+  StringOutputBuffer storage;
+  std::ostream rules(&storage);
 
   // Call out to the correct sub-type of writer. Binary targets need to be
   // written to separate files for compiler flag scoping, but other target
@@ -101,7 +103,7 @@ std::string NinjaTargetWriter::RunAndWriteFile(const Target* target) {
     base::FilePath full_ninja_file =
         settings->build_settings()->GetFullPath(ninja_file);
     base::CreateDirectory(full_ninja_file.DirName());
-    WriteFileIfChanged(full_ninja_file, rules.str(), nullptr);
+    storage.WriteToFileIfChanged(full_ninja_file, nullptr);
 
     EscapeOptions options;
     options.mode = ESCAPE_NINJA;
@@ -116,7 +118,7 @@ std::string NinjaTargetWriter::RunAndWriteFile(const Target* target) {
   }
 
   // No separate file required, just return the rules.
-  return rules.str();
+  return storage.str();
 }
 
 void NinjaTargetWriter::WriteEscapedSubstitution(SubstitutionType type) {
@@ -4,15 +4,16 @@
 
 #include "tools/gn/ninja_toolchain_writer.h"
 
-#include <fstream>
+#include <memory>
+#include <ostream>
 
-#include "base/files/file_util.h"
 #include "base/strings/stringize_macros.h"
 #include "tools/gn/build_settings.h"
 #include "tools/gn/filesystem_utils.h"
 #include "tools/gn/ninja_utils.h"
 #include "tools/gn/pool.h"
 #include "tools/gn/settings.h"
+#include "tools/gn/string_output_buffer.h"
 #include "tools/gn/substitution_writer.h"
 #include "tools/gn/target.h"
 #include "tools/gn/toolchain.h"
@@ -59,21 +60,42 @@ bool NinjaToolchainWriter::RunAndWriteFile(
     const Settings* settings,
     const Toolchain* toolchain,
     const std::vector<NinjaWriter::TargetRulePair>& rules) {
-  base::FilePath ninja_file(settings->build_settings()->GetFullPath(
-      GetNinjaFileForToolchain(settings)));
+  const BuildSettings* build_settings = settings->build_settings();
+  SourceFile ninja_source = GetNinjaFileForToolchain(settings);
+  base::FilePath ninja_file(build_settings->GetFullPath(ninja_source));
   ScopedTrace trace(TraceItem::TRACE_FILE_WRITE, FilePathToUTF8(ninja_file));
 
-  base::CreateDirectory(ninja_file.DirName());
+  StringOutputBuffer storage;
+  std::ostream file(&storage);
+  NinjaToolchainWriter gen(settings, toolchain, file);
 
-  std::ofstream file;
-  file.open(FilePathToUTF8(ninja_file).c_str(),
-            std::ios_base::out | std::ios_base::binary);
-  if (file.fail())
-    return false;
+  size_t shard_count = build_settings->ninja_shard_count();
+  if (shard_count <= 1) {
+    gen.Run(rules);
+    return storage.WriteToFile(ninja_file, nullptr);
+  }
 
-  NinjaToolchainWriter gen(settings, toolchain, file);
-  gen.Run(rules);
-  return true;
+  // Write the tool rules here and split the target rules between the shard
+  // files, which ninja loads as part of this one. A target always goes to the
+  // same shard, so shards without changed targets are left untouched.
+  gen.Run(std::vector<NinjaWriter::TargetRulePair>());
+  std::vector<std::unique_ptr<StringOutputBuffer>> shards;
+  for (size_t i = 0; i < shard_count; i++)
+    shards.emplace_back(new StringOutputBuffer);
+  for (const auto& pair : rules) {
+    shards[GetNinjaShardForTarget(pair.first, shard_count)]->Append(
+        pair.second);
+  }
+  for (size_t i = 0; i < shard_count; i++) {
+    SourceFile shard_file = GetNinjaShardFile(ninja_source, i);
+    if (!shards[i]->WriteToFileIfChanged(
+            build_settings->GetFullPath(shard_file), nullptr))
+      return false;
+    file << "subninja ";
+    gen.path_output_.WriteFile(file, shard_file);
+    file << "\n";
+  }
+  return storage.WriteToFile(ninja_file, nullptr);
 }
 
 void NinjaToolchainWriter::WriteToolRule(const Toolchain::ToolType type,
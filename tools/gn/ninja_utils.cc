@@ -4,6 +4,10 @@
 
 #include "tools/gn/ninja_utils.h"
 
+#include <stdint.h>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
 #include "tools/gn/filesystem_utils.h"
 #include "tools/gn/settings.h"
 #include "tools/gn/target.h"
@@ -21,6 +25,25 @@ SourceFile GetNinjaFileForToolchain(const Settings* settings) {
                     "toolchain.ninja");
 }
 
+size_t GetNinjaShardForTarget(const Target* target, size_t shard_count) {
+  // FNV-1a, which unlike std::hash gives the same result on every platform
+  // and standard library.
+  const std::string name = target->label().GetUserVisibleName(true);
+  uint32_t hash = 2166136261u;
+  for (char c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 16777619u;
+  }
+  return hash % shard_count;
+}
+
+SourceFile GetNinjaShardFile(const SourceFile& ninja_file, size_t shard) {
+  const std::string& value = ninja_file.value();
+  DCHECK(base::EndsWith(value, ".ninja", base::CompareCase::SENSITIVE));
+  return SourceFile(value.substr(0, value.size() - 5) +
+                    base::NumberToString(shard) + ".ninja");
+}
+
 std::string GetNinjaRulePrefixForToolchain(const Settings* settings) {
   // Don't prefix the default toolchain so it looks prettier, prefix everything
   // else.
@@ -5,6 +5,8 @@
 #ifndef TOOLS_GN_NINJA_UTILS_H_
 #define TOOLS_GN_NINJA_UTILS_H_
 
+#include <stddef.h>
+
 #include <string>
 
 class Settings;
@@ -18,6 +20,15 @@ SourceFile GetNinjaFileForTarget(const Target* target);
 // Returns the name of the root .ninja file for the given toolchain.
 SourceFile GetNinjaFileForToolchain(const Settings* settings);
 
+// Returns which of |shard_count| files the rules of the given target go to
+// when the ninja files are split (see BuildSettings::ninja_shard_count()). This
+// only depends on the label, so a target stays in the same file across runs.
+size_t GetNinjaShardForTarget(const Target* target, size_t shard_count);
+
+// Returns the name of the given shard of a .ninja file. Example:
+// "toolchain.ninja" -> "toolchain.3.ninja".
+SourceFile GetNinjaShardFile(const SourceFile& ninja_file, size_t shard);
+
 // Returns the prefix applied to the Ninja rules in a given toolchain so they
 // don't collide with rules from other toolchains.
 std::string GetNinjaRulePrefixForToolchain(const Settings* settings);
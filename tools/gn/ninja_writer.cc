@@ -4,14 +4,36 @@
 
 #include "tools/gn/ninja_writer.h"
 
+#include <memory>
+
+#include "base/bind.h"
 #include "tools/gn/builder.h"
 #include "tools/gn/loader.h"
 #include "tools/gn/location.h"
 #include "tools/gn/ninja_build_writer.h"
 #include "tools/gn/ninja_toolchain_writer.h"
+#include "tools/gn/scheduler.h"
 #include "tools/gn/settings.h"
 #include "tools/gn/target.h"
 
+namespace {
+
+void WriteToolchainFile(const Settings* settings,
+                        const Toolchain* toolchain,
+                        const std::vector<NinjaWriter::TargetRulePair>* rules,
+                        bool* success) {
+  *success = NinjaToolchainWriter::RunAndWriteFile(settings, toolchain, *rules);
+}
+
+void WriteBuildFile(const BuildSettings* build_settings,
+                    const Builder* builder,
+                    bool* success,
+                    Err* err) {
+  *success = NinjaBuildWriter::RunAndWriteFile(build_settings, *builder, err);
+}
+
+}  // namespace
+
 NinjaWriter::NinjaWriter(const Builder& builder) : builder_(builder) {}
 
 NinjaWriter::~NinjaWriter() = default;
@@ -22,14 +44,12 @@ bool NinjaWriter::RunAndWriteFiles(const BuildSettings* build_settings,
                                    const PerToolchainRules& per_toolchain_rules,
                                    Err* err) {
   NinjaWriter writer(builder);
-
-  if (!writer.WriteToolchains(per_toolchain_rules, err))
-    return false;
-  return NinjaBuildWriter::RunAndWriteFile(build_settings, builder, err);
+  return writer.WriteFiles(build_settings, per_toolchain_rules, err);
 }
 
-bool NinjaWriter::WriteToolchains(const PerToolchainRules& per_toolchain_rules,
-                                  Err* err) {
+bool NinjaWriter::WriteFiles(const BuildSettings* build_settings,
+                             const PerToolchainRules& per_toolchain_rules,
+                             Err* err) {
   if (per_toolchain_rules.empty()) {
     Err(Location(), "No targets.",
         "I could not find any targets to write, so I'm doing nothing.")
@@ -37,16 +57,34 @@ bool NinjaWriter::WriteToolchains(const PerToolchainRules& per_toolchain_rules,
     return false;
   }
 
+  // The toolchain files and build.ninja don't depend on each other, so write
+  // them all in parallel on the worker pool.
+  PendingPoolTasks pending;
+  std::unique_ptr<bool[]> toolchain_success(
+      new bool[per_toolchain_rules.size()]);
+  size_t toolchain_index = 0;
   for (const auto& i : per_toolchain_rules) {
     const Toolchain* toolchain = i.first;
     const Settings* settings =
         builder_.loader()->GetToolchainSettings(toolchain->label());
-    if (!NinjaToolchainWriter::RunAndWriteFile(settings, toolchain, i.second)) {
+    g_scheduler->PostPoolTask(
+        base::BindOnce(&WriteToolchainFile, settings, toolchain, &i.second,
+                       &toolchain_success[toolchain_index++]),
+        &pending);
+  }
+
+  bool build_success = false;
+  g_scheduler->PostPoolTask(base::BindOnce(&WriteBuildFile, build_settings,
+                                           &builder_, &build_success, err),
+                            &pending);
+  pending.Wait();
+
+  for (size_t i = 0; i < per_toolchain_rules.size(); i++) {
+    if (!toolchain_success[i]) {
       Err(Location(), "Couldn't open toolchain buildfile(s) for writing")
           .PrintToStdout();
       return false;
     }
   }
-
-  return true;
+  return build_success;
 }
@@ -39,7 +39,10 @@ class NinjaWriter {
   NinjaWriter(const Builder& builder);
   ~NinjaWriter();
 
-  bool WriteToolchains(const PerToolchainRules& per_toolchain_rules, Err* err);
+  // Writes the toolchain files and build.ninja in parallel.
+  bool WriteFiles(const BuildSettings* build_settings,
+                  const PerToolchainRules& per_toolchain_rules,
+                  Err* err);
 
   const Builder& builder_;
 
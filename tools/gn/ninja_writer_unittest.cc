@@ -0,0 +1,139 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/ninja_writer.h"
+
+#include <string>
+
+#include "base/command_line.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "tools/gn/err.h"
+#include "tools/gn/filesystem_utils.h"
+#include "tools/gn/setup.h"
+#include "tools/gn/switches.h"
+#include "tools/gn/target.h"
+#include "util/msg_loop.h"
+#include "util/test/test.h"
+
+namespace {
+
+void WriteFile(const base::FilePath& path, const std::string& data) {
+  ASSERT_EQ(static_cast<int>(data.size()),
+            base::WriteFile(path, data.data(), static_cast<int>(data.size())));
+}
+
+std::string ReadFile(const base::FilePath& path) {
+  std::string contents;
+  EXPECT_TRUE(base::ReadFileToString(path, &contents)) << path.value();
+  return contents;
+}
+
+// Loads a build with targets in two toolchains, "//build:a" (the default) and
+// "//build:b", and writes it with NinjaWriter.
+class NinjaWriterTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    root_ = temp_dir_.GetPath();
+    out_ = root_.AppendASCII("out");
+    WriteFile(root_.AppendASCII(".gn"), "buildconfig = \"//BUILDCONFIG.gn\"\n");
+    WriteFile(root_.AppendASCII("BUILDCONFIG.gn"),
+              "set_default_toolchain(\"//build:a\")\n");
+    ASSERT_TRUE(base::CreateDirectory(root_.AppendASCII("build")));
+    WriteFile(root_.AppendASCII("build").AppendASCII("BUILD.gn"),
+              "foreach(name, [ \"a\", \"b\" ]) {\n"
+              "  toolchain(name) {\n"
+              "    tool(\"stamp\") {\n"
+              "      command = \"touch {{output}}\"\n"
+              "    }\n"
+              "  }\n"
+              "}\n");
+  }
+
+  // Loads the build with the given //BUILD.gn and writes a rule for each
+  // target. Returns whether NinjaWriter succeeded.
+  bool LoadAndWrite(const std::string& build_file, Err* err) {
+    WriteFile(root_.AppendASCII("BUILD.gn"), build_file);
+
+    base::CommandLine cmdline(base::CommandLine::NO_PROGRAM);
+    cmdline.AppendSwitchASCII(switches::kRoot, FilePathToUTF8(root_));
+    cmdline.AppendSwitch(switches::kQuiet);
+    EXPECT_TRUE(setup_.DoSetup(FilePathToUTF8(out_), true, cmdline));
+    EXPECT_TRUE(setup_.Run(cmdline));
+
+    NinjaWriter::PerToolchainRules rules;
+    for (const Target* target : setup_.builder().GetAllResolvedTargets()) {
+      rules[target->toolchain()].emplace_back(
+          target, "# " + target->label().GetUserVisibleName(false) + "\n");
+    }
+    return NinjaWriter::RunAndWriteFiles(&setup_.build_settings(),
+                                         setup_.builder(), rules, err);
+  }
+
+  MsgLoop msg_loop_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath root_;
+  base::FilePath out_;
+  Setup setup_;
+};
+
+const char kTwoToolchains[] =
+    "group(\"x\") {\n"
+    "  deps = [ \":y(//build:b)\" ]\n"
+    "}\n"
+    "group(\"y\") {}\n";
+
+}  // namespace
+
+TEST_F(NinjaWriterTest, SeveralToolchains) {
+  Err err;
+  ASSERT_TRUE(LoadAndWrite(kTwoToolchains, &err)) << err.message();
+
+  // All targets of the default toolchain are written, but only the ones that
+  // are depended on in other toolchains.
+  std::string default_toolchain =
+      ReadFile(out_.AppendASCII("toolchain.ninja"));
+  EXPECT_NE(std::string::npos, default_toolchain.find("# //:x\n"));
+  EXPECT_NE(std::string::npos, default_toolchain.find("# //:y\n"));
+
+  std::string other_toolchain =
+      ReadFile(out_.AppendASCII("b").AppendASCII("toolchain.ninja"));
+  EXPECT_NE(std::string::npos, other_toolchain.find("# //:y\n"));
+  EXPECT_EQ(std::string::npos, other_toolchain.find("# //:x\n"));
+
+  std::string build = ReadFile(out_.AppendASCII("build.ninja"));
+  EXPECT_NE(std::string::npos, build.find("subninja toolchain.ninja\n"));
+  EXPECT_NE(std::string::npos, build.find("subninja b/toolchain.ninja\n"));
+}
+
+TEST_F(NinjaWriterTest, ToolchainFileError) {
+  // A directory in place of the file of the second toolchain.
+  ASSERT_TRUE(base::CreateDirectory(
+      out_.AppendASCII("b").AppendASCII("toolchain.ninja")));
+
+  Err err;
+  EXPECT_FALSE(LoadAndWrite(kTwoToolchains, &err));
+
+  // The other files are still written.
+  EXPECT_TRUE(base::PathExists(out_.AppendASCII("toolchain.ninja")));
+  EXPECT_TRUE(base::PathExists(out_.AppendASCII("build.ninja")));
+}
+
+TEST_F(NinjaWriterTest, BuildFileError) {
+  // The error found while writing build.ninja is returned.
+  Err err;
+  EXPECT_FALSE(LoadAndWrite(
+      "action(\"x\") {\n"
+      "  script = \"//script.py\"\n"
+      "  outputs = [ \"$root_out_dir/same\" ]\n"
+      "}\n"
+      "action(\"y\") {\n"
+      "  script = \"//script.py\"\n"
+      "  outputs = [ \"$root_out_dir/same\" ]\n"
+      "}\n",
+      &err));
+  EXPECT_TRUE(err.has_error());
+  EXPECT_EQ("Duplicate output file.", err.message());
+}
@@ -0,0 +1,539 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/parse_cache.h"
+
+#include <utility>
+
+#include "tools/gn/filesystem_utils.h"
+#include "tools/gn/input_file.h"
+#include "tools/gn/parse_tree.h"
+#include "tools/gn/token.h"
+
+namespace {
+
+const char kParseCacheMagic[] = "GNPC";
+
+// Increment when the token or parse node layout below changes.
+const uint32_t kParseCacheVersion = 1;
+
+enum NodeTag {
+  NODE_NULL,
+  NODE_ACCESSOR,
+  NODE_BINARY_OP,
+  NODE_BLOCK,
+  NODE_BLOCK_COMMENT,
+  NODE_CONDITION,
+  NODE_END,
+  NODE_FUNCTION_CALL,
+  NODE_IDENTIFIER,
+  NODE_LIST,
+  NODE_LITERAL,
+  NODE_UNARY_OP,
+  NODE_NUM_TAGS
+};
+
+// Writing ---------------------------------------------------------------------
+
+class TreeWriter {
+ public:
+  TreeWriter(const InputFile* file, CacheWriter* writer)
+      : contents_(file->contents()), file_(file), writer_(writer) {}
+
+  // Tokens are stored as their type and location. The value is always the
+  // part of the file contents starting at the location's byte offset.
+  bool WriteToken(const Token& token) {
+    writer_->WriteVarint(token.type());
+    const Location& location = token.location();
+    if (!location.file()) {
+      // Default-constructed tokens, e.g. the begin token of the file's block.
+      if (!token.value().empty())
+        return false;
+      writer_->WriteVarint(0);
+      return true;
+    }
+    if (location.file() != file_ || location.byte() < 0 ||
+        token.value().data() != contents_.data() + location.byte() ||
+        static_cast<size_t>(location.byte()) + token.value().size() >
+            contents_.size())
+      return false;
+    writer_->WriteVarint(1);
+    writer_->WriteVarint(location.line_number());
+    writer_->WriteVarint(location.column_number());
+    writer_->WriteVarint(location.byte());
+    writer_->WriteVarint(token.value().size());
+    return true;
+  }
+
+  bool WriteTokens(const std::vector<Token>& tokens) {
+    writer_->WriteVarint(tokens.size());
+    for (const Token& token : tokens) {
+      if (!WriteToken(token))
+        return false;
+    }
+    return true;
+  }
+
+  bool WriteNode(const ParseNode* node) {
+    if (!node) {
+      writer_->WriteVarint(NODE_NULL);
+      return true;
+    }
+
+    bool ok = false;
+    if (const AccessorNode* accessor = node->AsAccessor()) {
+      writer_->WriteVarint(NODE_ACCESSOR);
+      ok = WriteToken(accessor->base()) && WriteNode(accessor->index()) &&
+           WriteNode(accessor->member());
+    } else if (const BinaryOpNode* binary_op = node->AsBinaryOp()) {
+      writer_->WriteVarint(NODE_BINARY_OP);
+      ok = WriteToken(binary_op->op()) && WriteNode(binary_op->left()) &&
+           WriteNode(binary_op->right());
+    } else if (const BlockNode* block = node->AsBlock()) {
+      writer_->WriteVarint(NODE_BLOCK);
+      writer_->WriteVarint(block->result_mode());
+      ok = WriteToken(block->Begin()) && WriteNode(block->End());
+      writer_->WriteVarint(block->statements().size());
+      for (const auto& statement : block->statements())
+        ok = ok && WriteNode(statement.get());
+    } else if (const BlockCommentNode* comment = node->AsBlockComment()) {
+      writer_->WriteVarint(NODE_BLOCK_COMMENT);
+      ok = WriteToken(comment->comment());
+    } else if (const ConditionNode* condition = node->AsConditionNode()) {
+      writer_->WriteVarint(NODE_CONDITION);
+      ok = WriteToken(condition->if_token()) &&
+           WriteNode(condition->condition()) &&
+           WriteNode(condition->if_true()) && WriteNode(condition->if_false());
+    } else if (const EndNode* end = node->AsEnd()) {
+      writer_->WriteVarint(NODE_END);
+      ok = WriteToken(end->value());
+    } else if (const FunctionCallNode* call = node->AsFunctionCall()) {
+      writer_->WriteVarint(NODE_FUNCTION_CALL);
+      ok = WriteToken(call->function()) && WriteNode(call->args()) &&
+           WriteNode(call->block());
+    } else if (const IdentifierNode* identifier = node->AsIdentifier()) {
+      writer_->WriteVarint(NODE_IDENTIFIER);
+      ok = WriteToken(identifier->value());
+    } else if (const ListNode* list = node->AsList()) {
+      writer_->WriteVarint(NODE_LIST);
+      writer_->WriteVarint(list->prefer_multiline());
+      ok = WriteToken(list->Begin()) && WriteNode(list->End());
+      writer_->WriteVarint(list->contents().size());
+      for (const auto& item : list->contents())
+        ok = ok && WriteNode(item.get());
+    } else if (const LiteralNode* literal = node->AsLiteral()) {
+      writer_->WriteVarint(NODE_LITERAL);
+      ok = WriteToken(literal->value());
+    } else if (const UnaryOpNode* unary_op = node->AsUnaryOp()) {
+      writer_->WriteVarint(NODE_UNARY_OP);
+      ok = WriteToken(unary_op->op()) && WriteNode(unary_op->operand());
+    }
+    return ok && WriteComments(node->comments());
+  }
+
+ private:
+  bool WriteComments(const Comments* comments) {
+    if (!comments) {
+      writer_->WriteVarint(0);
+      return true;
+    }
+    writer_->WriteVarint(1);
+    return WriteTokens(comments->before()) &&
+           WriteTokens(comments->suffix()) && WriteTokens(comments->after());
+  }
+
+  const std::string& contents_;
+  const InputFile* file_;
+  CacheWriter* writer_;
+
+  DISALLOW_COPY_AND_ASSIGN(TreeWriter);
+};
+
+// Reading ---------------------------------------------------------------------
+
+class TreeReader {
+ public:
+  TreeReader(const InputFile* file, CacheReader* reader)
+      : contents_(file->contents()), file_(file), reader_(reader) {}
+
+  bool ReadToken(Token* token) {
+    int type;
+    int has_location;
+    if (!reader_->ReadInt(&type) || type >= Token::NUM_TYPES ||
+        !reader_->ReadInt(&has_location))
+      return false;
+    if (!has_location) {
+      *token = Token(Location(), static_cast<Token::Type>(type),
+                     base::StringPiece());
+      return true;
+    }
+
+    int line, column, byte, size;
+    if (!reader_->ReadInt(&line) || !reader_->ReadInt(&column) ||
+        !reader_->ReadInt(&byte) || !reader_->ReadInt(&size) ||
+        static_cast<size_t>(byte) + static_cast<size_t>(size) >
+            contents_.size())
+      return false;
+    *token = Token(Location(file_, line, column, byte),
+                   static_cast<Token::Type>(type),
+                   base::StringPiece(contents_.data() + byte, size));
+    return true;
+  }
+
+  bool ReadTokens(std::vector<Token>* tokens) {
+    uint64_t count;
+    if (!reader_->ReadVarint(&count) || count > contents_.size())
+      return false;
+    tokens->resize(static_cast<size_t>(count));
+    for (Token& token : *tokens) {
+      if (!ReadToken(&token))
+        return false;
+    }
+    return true;
+  }
+
+  // Reads a node that must be of the given type (or null).
+  template <typename NodeType>
+  bool ReadTypedNode(int expected_tag, std::unique_ptr<NodeType>* out) {
+    std::unique_ptr<ParseNode> node;
+    int tag;
+    if (!ReadNode(&node, &tag))
+      return false;
+    if (tag == NODE_NULL)
+      return true;
+    if (tag != expected_tag)
+      return false;
+    out->reset(static_cast<NodeType*>(node.release()));
+    return true;
+  }
+
+  bool ReadNode(std::unique_ptr<ParseNode>* out, int* out_tag) {
+    int tag;
+    if (!reader_->ReadInt(&tag) || tag >= NODE_NUM_TAGS)
+      return false;
+    *out_tag = tag;
+    if (tag == NODE_NULL)
+      return true;
+
+    Token token;
+    switch (tag) {
+      case NODE_ACCESSOR: {
+        auto accessor = std::make_unique<AccessorNode>();
+        std::unique_ptr<ParseNode> index;
+        std::unique_ptr<IdentifierNode> member;
+        if (!ReadToken(&token) || !ReadNode(&index) ||
+            !ReadTypedNode(NODE_IDENTIFIER, &member))
+          return false;
+        accessor->set_base(token);
+        if (index)
+          accessor->set_index(std::move(index));
+        if (member)
+          accessor->set_member(std::move(member));
+        *out = std::move(accessor);
+        break;
+      }
+      case NODE_BINARY_OP: {
+        auto binary_op = std::make_unique<BinaryOpNode>();
+        std::unique_ptr<ParseNode> left, right;
+        if (!ReadToken(&token) || !ReadNode(&left) || !ReadNode(&right))
+          return false;
+        binary_op->set_op(token);
+        binary_op->set_left(std::move(left));
+        binary_op->set_right(std::move(right));
+        *out = std::move(binary_op);
+        break;
+      }
+      case NODE_BLOCK: {
+        int result_mode;
+        std::unique_ptr<EndNode> end;
+        if (!reader_->ReadInt(&result_mode) ||
+            result_mode > BlockNode::DISCARDS_RESULT || !ReadToken(&token) ||
+            !ReadTypedNode(NODE_END, &end))
+          return false;
+        auto block = std::make_unique<BlockNode>(
+            static_cast<BlockNode::ResultMode>(result_mode));
+        block->set_begin_token(token);
+        if (end)
+          block->set_end(std::move(end));
+        uint64_t count;
+        if (!reader_->ReadVarint(&count))
+          return false;
+        for (uint64_t i = 0; i < count; i++) {
+          std::unique_ptr<ParseNode> statement;
+          if (!ReadNode(&statement) || !statement)
+            return false;
+          block->append_statement(std::move(statement));
+        }
+        *out = std::move(block);
+        break;
+      }
+      case NODE_BLOCK_COMMENT: {
+        auto comment = std::make_unique<BlockCommentNode>();
+        if (!ReadToken(&token))
+          return false;
+        comment->set_comment(token);
+        *out = std::move(comment);
+        break;
+      }
+      case NODE_CONDITION: {
+        auto condition = std::make_unique<ConditionNode>();
+        std::unique_ptr<ParseNode> condition_expr, if_false;
+        std::unique_ptr<BlockNode> if_true;
+        if (!ReadToken(&token) || !ReadNode(&condition_expr) ||
+            !ReadTypedNode(NODE_BLOCK, &if_true) || !ReadNode(&if_false))
+          return false;
+        condition->set_if_token(token);
+        condition->set_condition(std::move(condition_expr));
+        condition->set_if_true(std::move(if_true));
+        if (if_false)
+          condition->set_if_false(std::move(if_false));
+        *out = std::move(condition);
+        break;
+      }
+      case NODE_END: {
+        if (!ReadToken(&token))
+          return false;
+        *out = std::make_unique<EndNode>(token);
+        break;
+      }
+      case NODE_FUNCTION_CALL: {
+        auto call = std::make_unique<FunctionCallNode>();
+        std::unique_ptr<ListNode> args;
+        std::unique_ptr<BlockNode> block;
+        if (!ReadToken(&token) || !ReadTypedNode(NODE_LIST, &args) ||
+            !ReadTypedNode(NODE_BLOCK, &block))
+          return false;
+        call->set_function(token);
+        call->set_args(std::move(args));
+        if (block)
+          call->set_block(std::move(block));
+        *out = std::move(call);
+        break;
+      }
+      case NODE_IDENTIFIER: {
+        if (!ReadToken(&token))
+          return false;
+        *out = std::make_unique<IdentifierNode>(token);
+        break;
+      }
+      case NODE_LIST: {
+        auto list = std::make_unique<ListNode>();
+        int prefer_multiline;
+        std::unique_ptr<EndNode> end;
+        if (!reader_->ReadInt(&prefer_multiline) || !ReadToken(&token) ||
+            !ReadTypedNode(NODE_END, &end))
+          return false;
+        list->set_prefer_multiline(!!prefer_multiline);
+        list->set_begin_token(token);
+        if (end)
+          list->set_end(std::move(end));
+        uint64_t count;
+        if (!reader_->ReadVarint(&count))
+          return false;
+        for (uint64_t i = 0; i < count; i++) {
+          std::unique_ptr<ParseNode> item;
+          if (!ReadNode(&item) || !item)
+            return false;
+          list->append_item(std::move(item));
+        }
+        *out = std::move(list);
+        break;
+      }
+      case NODE_LITERAL: {
+        if (!ReadToken(&token))
+          return false;
+        *out = std::make_unique<LiteralNode>(token);
+        break;
+      }
+      case NODE_UNARY_OP: {
+        auto unary_op = std::make_unique<UnaryOpNode>();
+        std::unique_ptr<ParseNode> operand;
+        if (!ReadToken(&token) || !ReadNode(&operand))
+          return false;
+        unary_op->set_op(token);
+        unary_op->set_operand(std::move(operand));
+        *out = std::move(unary_op);
+        break;
+      }
+    }
+    return ReadComments(out->get());
+  }
+
+  bool ReadNode(std::unique_ptr<ParseNode>* out) {
+    int tag;
+    return ReadNode(out, &tag);
+  }
+
+ private:
+  bool ReadComments(ParseNode* node) {
+    int has_comments;
+    if (!reader_->ReadInt(&has_comments))
+      return false;
+    if (!has_comments)
+      return true;
+
+    std::vector<Token> before, suffix, after;
+    if (!ReadTokens(&before) || !ReadTokens(&suffix) || !ReadTokens(&after))
+      return false;
+    Comments* comments = node->comments_mutable();
+    for (const Token& token : before)
+      comments->append_before(token);
+    for (const Token& token : suffix)
+      comments->append_suffix(token);
+    for (const Token& token : after)
+      comments->append_after(token);
+    return true;
+  }
+
+  const std::string& contents_;
+  const InputFile* file_;
+  CacheReader* reader_;
+
+  DISALLOW_COPY_AND_ASSIGN(TreeReader);
+};
+
+}  // namespace
+
+ParseCache::Entry::Entry() : used(false) {}
+
+ParseCache::Entry::~Entry() = default;
+
+ParseCache::ParseCache(const base::FilePath& cache_file)
+    : cache_file_(cache_file), dirty_(false), hit_count_(0) {}
+
+ParseCache::~ParseCache() = default;
+
+void ParseCache::Load() {
+  std::string body;
+  if (!ReadCacheFile(cache_file_, kParseCacheMagic, kParseCacheVersion, &body))
+    return;
+
+  std::unordered_map<std::string, Entry> entries;
+  CacheReader reader(body);
+  uint64_t count;
+  if (!reader.ReadVarint(&count))
+    return;
+  for (uint64_t i = 0; i < count; i++) {
+    base::StringPiece name;
+    Entry entry;
+    base::StringPiece data;
+    if (!reader.ReadString(&name) || !entry.stamp.Read(&reader) ||
+        !reader.ReadString(&data))
+      return;  // Corrupt, ignore the whole file.
+    entry.data = std::make_shared<const std::string>(data.as_string());
+    entries[name.as_string()] = std::move(entry);
+  }
+  if (!reader.at_end())
+    return;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_ = std::move(entries);
+}
+
+bool ParseCache::Save() {
+  CacheWriter writer;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    size_t used_count = 0;
+    for (const auto& pair : entries_) {
+      if (pair.second.used)
+        used_count++;
+    }
+    if (!dirty_ && used_count == entries_.size())
+      return true;  // Nothing changed.
+
+    writer.WriteVarint(used_count);
+    for (const auto& pair : entries_) {
+      if (!pair.second.used)
+        continue;
+      writer.WriteString(pair.first);
+      pair.second.stamp.Write(&writer);
+      writer.WriteString(*pair.second.data);
+    }
+  }
+  return WriteCacheFile(cache_file_, kParseCacheMagic, kParseCacheVersion,
+                        writer);
+}
+
+bool ParseCache::Lookup(const InputFile* file,
+                        const base::File::Info& info,
+                        FileStamp* stamp,
+                        std::vector<Token>* tokens,
+                        std::unique_ptr<ParseNode>* root) {
+  if (!GetFileStampForContents(info, file->contents(), stamp))
+    return false;
+
+  const std::string name = FilePathToUTF8(file->physical_name());
+  std::shared_ptr<const std::string> data;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = entries_.find(name);
+    if (found == entries_.end() || !found->second.stamp.SameContents(*stamp))
+      return false;
+    data = found->second.data;
+  }
+
+  if (!Deserialize(file, *data, tokens, root)) {
+    tokens->clear();
+    root->reset();
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  Entry& entry = entries_[name];
+  entry.used = true;
+  if (entry.stamp.last_modified != stamp->last_modified) {
+    // Touched but unchanged. Remember the new time for the next run.
+    entry.stamp.last_modified = stamp->last_modified;
+    dirty_ = true;
+  }
+  hit_count_++;
+  return true;
+}
+
+void ParseCache::Add(const InputFile* file,
+                     const FileStamp& stamp,
+                     const std::vector<Token>& tokens,
+                     const ParseNode* root) {
+  if (stamp.size < 0)
+    return;  // Couldn't stat the file in Lookup().
+
+  CacheWriter writer;
+  if (!Serialize(file, tokens, root, &writer))
+    return;
+
+  Entry entry;
+  entry.stamp = stamp;
+  entry.data = std::make_shared<const std::string>(writer.data());
+  entry.used = true;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_[FilePathToUTF8(file->physical_name())] = std::move(entry);
+  dirty_ = true;
+}
+
+int ParseCache::hit_count() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return hit_count_;
+}
+
+// static
+bool ParseCache::Serialize(const InputFile* file,
+                           const std::vector<Token>& tokens,
+                           const ParseNode* root,
+                           CacheWriter* writer) {
+  TreeWriter tree_writer(file, writer);
+  return tree_writer.WriteTokens(tokens) && tree_writer.WriteNode(root);
+}
+
+// static
+bool ParseCache::Deserialize(const InputFile* file,
+                             const base::StringPiece& data,
+                             std::vector<Token>* tokens,
+                             std::unique_ptr<ParseNode>* root) {
+  CacheReader reader(data);
+  TreeReader tree_reader(file, &reader);
+  return tree_reader.ReadTokens(tokens) && tree_reader.ReadNode(root) &&
+         *root && reader.at_end();
+}
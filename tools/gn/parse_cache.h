@@ -0,0 +1,104 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_PARSE_CACHE_H_
+#define TOOLS_GN_PARSE_CACHE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "tools/gn/cache_file.h"
+
+class InputFile;
+class ParseNode;
+class Token;
+
+// Persistent cache of tokenized and parsed build files, stored in the build
+// directory (see the --parse-cache switch).
+//
+// Entries are keyed by the physical path of the file and are only used when
+// the size and contents digest of the file still match. Tokens and parse
+// nodes are stored as offsets into the file contents, so the file itself must
+// still be loaded; only tokenizing and parsing are skipped.
+//
+// This class is threadsafe.
+class ParseCache {
+ public:
+  explicit ParseCache(const base::FilePath& cache_file);
+  ~ParseCache();
+
+  // Reads the entries from the cache file. A missing or invalid cache file
+  // leaves the cache empty.
+  void Load();
+
+  // Writes the entries used during this run to the cache file, if anything
+  // changed since it was loaded. Entries that weren't used are dropped.
+  bool Save();
+
+  // Fills |tokens| and |root| for |file|, which must already be loaded, from
+  // the cache. |info| is the stat of the file taken before it was loaded (see
+  // GetFileStampForContents()). Returns false if there is no matching entry,
+  // in which case |stamp| is set to the stamp to pass to Add().
+  bool Lookup(const InputFile* file,
+              const base::File::Info& info,
+              FileStamp* stamp,
+              std::vector<Token>* tokens,
+              std::unique_ptr<ParseNode>* root);
+
+  // Adds the parse result for |file| to the cache.
+  void Add(const InputFile* file,
+           const FileStamp& stamp,
+           const std::vector<Token>& tokens,
+           const ParseNode* root);
+
+  // Number of successful lookups.
+  int hit_count() const;
+
+  // Serializes the tokens and tree of |file| into |writer|. Returns false if
+  // they can't be represented, e.g. a token that doesn't point into the file.
+  static bool Serialize(const InputFile* file,
+                        const std::vector<Token>& tokens,
+                        const ParseNode* root,
+                        CacheWriter* writer);
+
+  // The reverse of Serialize(). Returns false if the data is invalid.
+  static bool Deserialize(const InputFile* file,
+                          const base::StringPiece& data,
+                          std::vector<Token>* tokens,
+                          std::unique_ptr<ParseNode>* root);
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    FileStamp stamp;
+
+    // Shared so that lookups can deserialize outside the lock.
+    std::shared_ptr<const std::string> data;
+
+    bool used;
+  };
+
+  base::FilePath cache_file_;
+
+  mutable std::mutex lock_;
+
+  // Maps physical file names to entries.
+  std::unordered_map<std::string, Entry> entries_;
+
+  // Set when an entry was added or updated.
+  bool dirty_;
+
+  int hit_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParseCache);
+};
+
+#endif  // TOOLS_GN_PARSE_CACHE_H_
@@ -0,0 +1,188 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <sstream>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "tools/gn/input_file.h"
+#include "tools/gn/parse_cache.h"
+#include "tools/gn/parse_tree.h"
+#include "tools/gn/parser.h"
+#include "tools/gn/tokenizer.h"
+#include "util/test/test.h"
+
+namespace {
+
+const char kInput[] =
+    "# Leading comment.\n"
+    "declare_args() {\n"
+    "  enable_foo = true  # Suffix comment.\n"
+    "}\n"
+    "\n"
+    "if (enable_foo && !is_win) {\n"
+    "  static_library(\"foo\") {\n"
+    "    sources = [\n"
+    "      \"a.cc\",\n"
+    "      \"b.cc\",\n"
+    "    ]\n"
+    "    defines = invoker.defines + [ \"FOO=${x[0]}\" ]\n"
+    "  }\n"
+    "} else if (is_mac) {\n"
+    "  a = { b = 1 }\n"
+    "} else {\n"
+    "  a -= -1\n"
+    "}\n"
+    "# Trailing comment.\n";
+
+std::string RenderTree(const ParseNode* root) {
+  std::ostringstream out;
+  RenderToText(root->GetJSONNode(), 0, out);
+  return out.str();
+}
+
+bool Parse(const InputFile* file,
+           std::vector<Token>* tokens,
+           std::unique_ptr<ParseNode>* root) {
+  Err err;
+  *tokens = Tokenizer::Tokenize(file, &err);
+  if (err.has_error())
+    return false;
+  *root = Parser::Parse(*tokens, &err);
+  return !err.has_error();
+}
+
+void ExpectSameTokens(const std::vector<Token>& expected,
+                      const std::vector<Token>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].type(), actual[i].type());
+    EXPECT_EQ(expected[i].value(), actual[i].value());
+    EXPECT_TRUE(expected[i].location() == actual[i].location());
+  }
+}
+
+}  // namespace
+
+TEST(ParseCache, SerializeRoundTrip) {
+  InputFile file(SourceFile("//BUILD.gn"));
+  file.SetContents(kInput);
+
+  std::vector<Token> tokens;
+  std::unique_ptr<ParseNode> root;
+  ASSERT_TRUE(Parse(&file, &tokens, &root));
+
+  CacheWriter writer;
+  ASSERT_TRUE(ParseCache::Serialize(&file, tokens, root.get(), &writer));
+
+  std::vector<Token> read_tokens;
+  std::unique_ptr<ParseNode> read_root;
+  ASSERT_TRUE(ParseCache::Deserialize(&file, writer.data(), &read_tokens,
+                                      &read_root));
+
+  ExpectSameTokens(tokens, read_tokens);
+  EXPECT_EQ(RenderTree(root.get()), RenderTree(read_root.get()));
+
+  // Ranges are used for error messages so must survive the round trip.
+  const BlockNode* block = root->AsBlock();
+  const BlockNode* read_block = read_root->AsBlock();
+  ASSERT_TRUE(read_block);
+  ASSERT_EQ(block->statements().size(), read_block->statements().size());
+  for (size_t i = 0; i < block->statements().size(); i++) {
+    LocationRange range = block->statements()[i]->GetRange();
+    LocationRange read_range = read_block->statements()[i]->GetRange();
+    EXPECT_TRUE(range.begin() == read_range.begin());
+    EXPECT_TRUE(range.end() == read_range.end());
+  }
+
+  // Truncated data is rejected.
+  std::string truncated = writer.data().substr(0, writer.data().size() / 2);
+  EXPECT_FALSE(ParseCache::Deserialize(&file, truncated, &read_tokens,
+                                       &read_root));
+}
+
+TEST(ParseCache, SaveAndLoad) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath cache_path = temp_dir.GetPath().AppendASCII("gn_parse.cache");
+  base::FilePath build_path = temp_dir.GetPath().AppendASCII("BUILD.gn");
+
+  std::string contents(kInput);
+  base::WriteFile(build_path, contents.c_str(),
+                  static_cast<int>(contents.size()));
+
+  base::File::Info info;
+  ASSERT_TRUE(base::GetFileInfo(build_path, &info));
+  InputFile file(SourceFile("//BUILD.gn"));
+  ASSERT_TRUE(file.Load(build_path));
+
+  std::vector<Token> tokens;
+  std::unique_ptr<ParseNode> root;
+  ASSERT_TRUE(Parse(&file, &tokens, &root));
+
+  {
+    ParseCache cache(cache_path);
+    cache.Load();
+
+    FileStamp stamp;
+    std::vector<Token> cached_tokens;
+    std::unique_ptr<ParseNode> cached_root;
+    EXPECT_FALSE(
+        cache.Lookup(&file, info, &stamp, &cached_tokens, &cached_root));
+    cache.Add(&file, stamp, tokens, root.get());
+    EXPECT_TRUE(cache.Save());
+  }
+
+  // A new cache picks up the saved entry.
+  {
+    ParseCache cache(cache_path);
+    cache.Load();
+
+    FileStamp stamp;
+    std::vector<Token> cached_tokens;
+    std::unique_ptr<ParseNode> cached_root;
+    ASSERT_TRUE(
+        cache.Lookup(&file, info, &stamp, &cached_tokens, &cached_root));
+    EXPECT_EQ(1, cache.hit_count());
+    ExpectSameTokens(tokens, cached_tokens);
+    EXPECT_EQ(RenderTree(root.get()), RenderTree(cached_root.get()));
+  }
+
+  // Changing the contents invalidates the entry.
+  contents += "b = 2\n";
+  base::WriteFile(build_path, contents.c_str(),
+                  static_cast<int>(contents.size()));
+  ASSERT_TRUE(base::GetFileInfo(build_path, &info));
+  InputFile changed_file(SourceFile("//BUILD.gn"));
+  ASSERT_TRUE(changed_file.Load(build_path));
+  {
+    ParseCache cache(cache_path);
+    cache.Load();
+
+    FileStamp stamp;
+    std::vector<Token> cached_tokens;
+    std::unique_ptr<ParseNode> cached_root;
+    EXPECT_FALSE(cache.Lookup(&changed_file, info, &stamp, &cached_tokens,
+                              &cached_root));
+    EXPECT_EQ(0, cache.hit_count());
+  }
+
+  // A file that changed between being stat'ed and read isn't cached.
+  contents += "c = 3\n";
+  base::WriteFile(build_path, contents.c_str(),
+                  static_cast<int>(contents.size()));
+  InputFile racing_file(SourceFile("//BUILD.gn"));
+  ASSERT_TRUE(racing_file.Load(build_path));
+  {
+    ParseCache cache(cache_path);
+    cache.Load();
+
+    FileStamp stamp;
+    std::vector<Token> cached_tokens;
+    std::unique_ptr<ParseNode> cached_root;
+    EXPECT_FALSE(cache.Lookup(&racing_file, info, &stamp, &cached_tokens,
+                              &cached_root));
+    EXPECT_GT(0, stamp.size);
+  }
+}
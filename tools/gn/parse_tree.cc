@@ -13,6 +13,7 @@
 #include "base/json/string_escape.h"
 #include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
+#include "tools/gn/arena.h"
 #include "tools/gn/functions.h"
 #include "tools/gn/operators.h"
 #include "tools/gn/scope.h"
@@ -28,6 +29,12 @@ const char kJsonAfterComment[] = "after_comment";
 
 namespace {
 
+thread_local Arena* g_parse_node_arena = nullptr;
+
+// Each node is preceded by a pointer to the arena it was allocated from, or
+// null if it came from the heap. Nodes don't need more than pointer alignment.
+const size_t kNodeHeaderSize = sizeof(Arena*);
+
 enum DepsCategory {
   DEPS_CATEGORY_LOCAL,
   DEPS_CATEGORY_RELATIVE,
@@ -98,6 +105,36 @@ ParseNode::ParseNode() = default;
 
 ParseNode::~ParseNode() = default;
 
+// static
+void* ParseNode::operator new(size_t size) {
+  static_assert(alignof(ParseNode) <= kNodeHeaderSize,
+                "Nodes must fit the alignment of the header");
+  Arena* arena = g_parse_node_arena;
+  void* memory =
+      arena ? arena->Allocate(kNodeHeaderSize + size, alignof(Arena*))
+            : ::operator new(kNodeHeaderSize + size);
+  *static_cast<Arena**>(memory) = arena;
+  return static_cast<char*>(memory) + kNodeHeaderSize;
+}
+
+// static
+void ParseNode::operator delete(void* node) {
+  if (!node)
+    return;
+  char* memory = static_cast<char*>(node) - kNodeHeaderSize;
+  if (!*reinterpret_cast<Arena**>(memory))
+    ::operator delete(memory);
+}
+
+ScopedParseNodeArena::ScopedParseNodeArena(Arena* arena)
+    : previous_(g_parse_node_arena) {
+  g_parse_node_arena = arena;
+}
+
+ScopedParseNodeArena::~ScopedParseNodeArena() {
+  g_parse_node_arena = previous_;
+}
+
 const AccessorNode* ParseNode::AsAccessor() const {
   return nullptr;
 }
@@ -18,6 +18,7 @@
 #include "tools/gn/value.h"
 
 class AccessorNode;
+class Arena;
 class BinaryOpNode;
 class BlockCommentNode;
 class BlockNode;
@@ -74,11 +75,18 @@ class Comments {
 // ParseNode -------------------------------------------------------------------
 
 // A node in the AST.
+//
+// Nodes are allocated from the arena of the current ScopedParseNodeArena, if
+// any, and from the heap otherwise. Deleting a node allocated from an arena
+// runs its destructor but leaves the memory to the arena.
 class ParseNode {
  public:
   ParseNode();
   virtual ~ParseNode();
 
+  static void* operator new(size_t size);
+  static void operator delete(void* node);
+
   virtual const AccessorNode* AsAccessor() const;
   virtual const BinaryOpNode* AsBinaryOp() const;
   virtual const BlockCommentNode* AsBlockComment() const;
@@ -124,6 +132,20 @@ class ParseNode {
   DISALLOW_COPY_AND_ASSIGN(ParseNode);
 };
 
+// While an instance of this class is in scope, ParseNodes created on the
+// current thread are allocated from the given arena. The nodes must be
+// deleted before the arena.
+class ScopedParseNodeArena {
+ public:
+  explicit ScopedParseNodeArena(Arena* arena);
+  ~ScopedParseNodeArena();
+
+ private:
+  Arena* previous_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedParseNodeArena);
+};
+
 // AccessorNode ----------------------------------------------------------------
 
 // Access an array or scope element.
@@ -262,6 +284,7 @@ class BlockNode : public ParseNode {
   base::Value GetJSONNode() const override;
 
   void set_begin_token(const Token& t) { begin_token_ = t; }
+  const Token& Begin() const { return begin_token_; }
   void set_end(std::unique_ptr<EndNode> e) { end_ = std::move(e); }
   const EndNode* End() const { return end_.get(); }
 
@@ -303,6 +326,7 @@ class ConditionNode : public ParseNode {
   base::Value GetJSONNode() const override;
 
   void set_if_token(const Token& token) { if_token_ = token; }
+  const Token& if_token() const { return if_token_; }
 
   const ParseNode* condition() const { return condition_.get(); }
   void set_condition(std::unique_ptr<ParseNode> c) {
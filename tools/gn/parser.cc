@@ -530,9 +530,7 @@ std::unique_ptr<ParseNode> Parser::BinaryOperator(
 std::unique_ptr<ParseNode> Parser::IdentifierOrCall(
     std::unique_ptr<ParseNode> left,
     const Token& token) {
-  std::unique_ptr<ListNode> list = std::make_unique<ListNode>();
-  list->set_begin_token(token);
-  list->set_end(std::make_unique<EndNode>(token));
+  std::unique_ptr<ListNode> list;
   std::unique_ptr<BlockNode> block;
   bool has_arg = false;
   if (LookAhead(Token::LEFT_PAREN)) {
@@ -559,6 +557,14 @@ std::unique_ptr<ParseNode> Parser::IdentifierOrCall(
     // Not a function call, just a standalone identifier.
     return std::make_unique<IdentifierNode>(token);
   }
+
+  // Nodes are kept until the whole tree is freed (see ScopedParseNodeArena),
+  // so only make the empty argument list once it's known to be needed.
+  if (!list) {
+    list = std::make_unique<ListNode>();
+    list->set_begin_token(token);
+    list->set_end(std::make_unique<EndNode>(token));
+  }
   std::unique_ptr<FunctionCallNode> func_call =
       std::make_unique<FunctionCallNode>();
   func_call->set_function(token);
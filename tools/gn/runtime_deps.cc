@@ -5,9 +5,10 @@
 #include "tools/gn/runtime_deps.h"
 
 #include <map>
-#include <set>
-#include <sstream>
+#include <ostream>
+#include <unordered_map>
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/files/file_util.h"
 #include "base/strings/string_split.h"
@@ -19,6 +20,7 @@
 #include "tools/gn/output_file.h"
 #include "tools/gn/scheduler.h"
 #include "tools/gn/settings.h"
+#include "tools/gn/string_output_buffer.h"
 #include "tools/gn/switches.h"
 #include "tools/gn/target.h"
 #include "tools/gn/trace.h"
@@ -27,89 +29,25 @@ namespace {
 
 using RuntimeDepsVector = std::vector<std::pair<OutputFile, const Target*>>;
 
-// Adds the given file to the deps list if it hasn't already been listed in
-// the found_files list. Updates the list.
-void AddIfNew(const OutputFile& output_file,
-              const Target* source,
-              RuntimeDepsVector* deps,
-              std::set<OutputFile>* found_file) {
-  if (found_file->find(output_file) != found_file->end())
-    return;  // Already there.
-  deps->push_back(std::make_pair(output_file, source));
-}
-
 // Automatically converts a string that looks like a source to an OutputFile.
-void AddIfNew(const std::string& str,
-              const Target* source,
-              RuntimeDepsVector* deps,
-              std::set<OutputFile>* found_file) {
-  OutputFile output_file(
+OutputFile ToOutputFile(const std::string& str, const Target* source) {
+  return OutputFile(
       RebasePath(str, source->settings()->build_settings()->build_dir(),
                  source->settings()->build_settings()->root_path_utf8()));
-  AddIfNew(output_file, source, deps, found_file);
 }
 
-// To avoid duplicate traversals of targets, or duplicating output files that
-// might be listed by more than one target, the set of targets and output files
-// that have been found so far is passed. The "value" of the seen_targets map
-// is a boolean indicating if the seen dep was a data dep (true = data_dep).
-// data deps add more stuff, so we will want to revisit a target if it's a
-// data dependency and we've previously only seen it as a regular dep.
-void RecursiveCollectRuntimeDeps(const Target* target,
-                                 bool is_target_data_dep,
-                                 RuntimeDepsVector* deps,
-                                 std::map<const Target*, bool>* seen_targets,
-                                 std::set<OutputFile>* found_files) {
-  const auto& found_seen_target = seen_targets->find(target);
-  if (found_seen_target != seen_targets->end()) {
-    // Already visited.
-    if (found_seen_target->second || !is_target_data_dep) {
-      // Already visited as a data dep, or the current dep is not a data
-      // dep so visiting again will be a no-op.
-      return;
-    }
-    // In the else case, the previously seen target was a regular dependency
-    // and we'll now process it as a data dependency.
-  }
-  (*seen_targets)[target] = is_target_data_dep;
-
-  // Add the main output file for executables, shared libraries, and
-  // loadable modules.
-  if (target->output_type() == Target::EXECUTABLE ||
-      target->output_type() == Target::LOADABLE_MODULE ||
-      target->output_type() == Target::SHARED_LIBRARY) {
-    for (const auto& runtime_output : target->runtime_outputs())
-      AddIfNew(runtime_output, target, deps, found_files);
-  }
-
-  // Add all data files.
-  for (const auto& file : target->data())
-    AddIfNew(file, target, deps, found_files);
-
-  // Actions/copy have all outputs considered when the're a data dep.
-  if (is_target_data_dep && (target->output_type() == Target::ACTION ||
-                             target->output_type() == Target::ACTION_FOREACH ||
-                             target->output_type() == Target::COPY_FILES)) {
-    std::vector<SourceFile> outputs;
-    target->action_values().GetOutputsAsSourceFiles(target, &outputs);
-    for (const auto& output_file : outputs)
-      AddIfNew(output_file.value(), target, deps, found_files);
-  }
-
+// Calls |callback(dep, is_data_dep)| for each dependency of |target| that
+// contributes to its runtime deps, in order.
+template <typename Callback>
+void ForEachRuntimeDepsDep(const Target* target, const Callback& callback) {
   // Data dependencies.
-  for (const auto& dep_pair : target->data_deps()) {
-    RecursiveCollectRuntimeDeps(dep_pair.ptr, true, deps, seen_targets,
-                                found_files);
-  }
+  for (const auto& dep_pair : target->data_deps())
+    callback(dep_pair.ptr, true);
 
   // Do not recurse into bundle targets. A bundle's dependencies should be
   // copied into the bundle itself for run-time access.
-  if (target->output_type() == Target::CREATE_BUNDLE) {
-    SourceDir bundle_root_dir =
-        target->bundle_data().GetBundleRootDirOutputAsDir(target->settings());
-    AddIfNew(bundle_root_dir.value(), target, deps, found_files);
+  if (target->output_type() == Target::CREATE_BUNDLE)
     return;
-  }
 
   // Non-data dependencies (both public and private).
   for (const auto& dep_pair : target->GetDeps(Target::DEPS_LINKED)) {
@@ -122,11 +60,145 @@ void RecursiveCollectRuntimeDeps(const Target* target,
       // unless it were listed in data deps.
       continue;
     }
-    RecursiveCollectRuntimeDeps(dep_pair.ptr, false, deps, seen_targets,
-                                found_files);
+    callback(dep_pair.ptr, false);
   }
 }
 
+// The runtime deps of a set of targets.
+//
+// The files each target adds by itself are computed once, when the index is
+// built, for every target reachable from any of the roots. Computing the
+// runtime deps of many targets that share most of their dependencies (like
+// all the test binaries of a build) then only walks the graph and copies
+// those lists, and can be done from several threads at once.
+class RuntimeDepsIndex {
+ public:
+  explicit RuntimeDepsIndex(const std::vector<const Target*>& roots) {
+    std::vector<const Target*> stack;
+    for (const Target* root : roots) {
+      if (targets_.emplace(root, TargetFiles()).second)
+        stack.push_back(root);
+    }
+    while (!stack.empty()) {
+      const Target* target = stack.back();
+      stack.pop_back();
+      ComputeTargetFiles(target, &targets_[target]);
+      ForEachRuntimeDepsDep(target, [this, &stack](const Target* dep, bool) {
+        if (targets_.emplace(dep, TargetFiles()).second)
+          stack.push_back(dep);
+      });
+    }
+  }
+
+  // Returns the runtime deps of |root|, which must be one of the roots.
+  RuntimeDepsVector Compute(const Target* root) const {
+    RuntimeDepsVector result;
+    std::unordered_map<const Target*, bool> seen_targets;
+
+    // The initial target is not considered a data dependency so that actions's
+    // outputs (if the current target is an action) are not automatically
+    // considered data deps.
+    RecursiveCollectRuntimeDeps(root, false, &result, &seen_targets);
+    return result;
+  }
+
+ private:
+  // The files a target adds to the runtime deps of anything that reaches it.
+  struct TargetFiles {
+    // The main output files of executables, shared libraries, and loadable
+    // modules, followed by all data files.
+    std::vector<OutputFile> files;
+
+    // The outputs of actions and copies, only added for data deps.
+    std::vector<OutputFile> data_dep_outputs;
+
+    // Added after the data deps of a bundle, for bundles only.
+    std::vector<OutputFile> bundle_files;
+  };
+
+  static void ComputeTargetFiles(const Target* target, TargetFiles* result) {
+    // Add the main output file for executables, shared libraries, and
+    // loadable modules.
+    if (target->output_type() == Target::EXECUTABLE ||
+        target->output_type() == Target::LOADABLE_MODULE ||
+        target->output_type() == Target::SHARED_LIBRARY) {
+      for (const auto& runtime_output : target->runtime_outputs())
+        result->files.push_back(runtime_output);
+    }
+
+    // Add all data files.
+    for (const auto& file : target->data())
+      result->files.push_back(ToOutputFile(file, target));
+
+    // Actions/copy have all outputs considered when the're a data dep.
+    if (target->output_type() == Target::ACTION ||
+        target->output_type() == Target::ACTION_FOREACH ||
+        target->output_type() == Target::COPY_FILES) {
+      std::vector<SourceFile> outputs;
+      target->action_values().GetOutputsAsSourceFiles(target, &outputs);
+      for (const auto& output_file : outputs) {
+        result->data_dep_outputs.push_back(
+            ToOutputFile(output_file.value(), target));
+      }
+    }
+
+    if (target->output_type() == Target::CREATE_BUNDLE) {
+      SourceDir bundle_root_dir =
+          target->bundle_data().GetBundleRootDirOutputAsDir(
+              target->settings());
+      result->bundle_files.push_back(
+          ToOutputFile(bundle_root_dir.value(), target));
+    }
+  }
+
+  static void AddFiles(const std::vector<OutputFile>& files,
+                       const Target* source,
+                       RuntimeDepsVector* deps) {
+    for (const auto& file : files)
+      deps->push_back(std::make_pair(file, source));
+  }
+
+  // To avoid duplicate traversals of targets, the set of targets that have
+  // been found so far is passed. The "value" of the seen_targets map is a
+  // boolean indicating if the seen dep was a data dep (true = data_dep). data
+  // deps add more stuff, so we will want to revisit a target if it's a data
+  // dependency and we've previously only seen it as a regular dep.
+  void RecursiveCollectRuntimeDeps(
+      const Target* target,
+      bool is_target_data_dep,
+      RuntimeDepsVector* deps,
+      std::unordered_map<const Target*, bool>* seen_targets) const {
+    auto inserted = seen_targets->emplace(target, is_target_data_dep);
+    if (!inserted.second) {
+      // Already visited.
+      if (inserted.first->second || !is_target_data_dep) {
+        // Already visited as a data dep, or the current dep is not a data
+        // dep so visiting again will be a no-op.
+        return;
+      }
+      // In the else case, the previously seen target was a regular
+      // dependency and we'll now process it as a data dependency.
+      inserted.first->second = true;
+    }
+
+    const TargetFiles& target_files = targets_.at(target);
+    AddFiles(target_files.files, target, deps);
+    if (is_target_data_dep)
+      AddFiles(target_files.data_dep_outputs, target, deps);
+
+    ForEachRuntimeDepsDep(
+        target, [this, deps, seen_targets](const Target* dep, bool is_data) {
+          RecursiveCollectRuntimeDeps(dep, is_data, deps, seen_targets);
+        });
+
+    AddFiles(target_files.bundle_files, target, deps);
+  }
+
+  std::unordered_map<const Target*, TargetFiles> targets_;
+
+  DISALLOW_COPY_AND_ASSIGN(RuntimeDepsIndex);
+};
+
 bool CollectRuntimeDepsFromFlag(const Builder& builder,
                                 RuntimeDepsVector* files_to_write,
                                 Err* err) {
@@ -192,20 +264,22 @@ bool CollectRuntimeDepsFromFlag(const Builder& builder,
   return true;
 }
 
-bool WriteRuntimeDepsFile(const OutputFile& output_file,
+void WriteRuntimeDepsFile(const RuntimeDepsIndex* index,
+                          const OutputFile* output_file,
                           const Target* target,
                           Err* err) {
   SourceFile output_as_source =
-      output_file.AsSourceFile(target->settings()->build_settings());
+      output_file->AsSourceFile(target->settings()->build_settings());
   base::FilePath data_deps_file =
       target->settings()->build_settings()->GetFullPath(output_as_source);
 
-  std::stringstream contents;
-  for (const auto& pair : ComputeRuntimeDeps(target))
-    contents << pair.first.value() << std::endl;
+  StringOutputBuffer storage;
+  std::ostream contents(&storage);
+  for (const auto& pair : index->Compute(target))
+    contents << pair.first.value() << '\n';
 
   ScopedTrace trace(TraceItem::TRACE_FILE_WRITE, output_as_source.value());
-  return WriteFileIfChanged(data_deps_file, contents.str(), err);
+  storage.WriteToFileIfChanged(data_deps_file, err);
 }
 
 }  // namespace
@@ -280,16 +354,7 @@ Multiple outputs
 )";
 
 RuntimeDepsVector ComputeRuntimeDeps(const Target* target) {
-  RuntimeDepsVector result;
-  std::map<const Target*, bool> seen_targets;
-  std::set<OutputFile> found_files;
-
-  // The initial target is not considered a data dependency so that actions's
-  // outputs (if the current target is an action) are not automatically
-  // considered data deps.
-  RecursiveCollectRuntimeDeps(target, false, &result, &seen_targets,
-                              &found_files);
-  return result;
+  return RuntimeDepsIndex(std::vector<const Target*>{target}).Compute(target);
 }
 
 bool WriteRuntimeDepsFilesIfNecessary(const Builder& builder, Err* err) {
@@ -303,12 +368,40 @@ bool WriteRuntimeDepsFilesIfNecessary(const Builder& builder, Err* err) {
         std::make_pair(target->write_runtime_deps_output(), target));
   }
 
-  for (const auto& entry : files_to_write) {
-    // Currently this writes all runtime deps files sequentially. We generally
-    // expect few of these. We can run this on the worker pool if it looks
-    // like it's talking a long time.
-    if (!WriteRuntimeDepsFile(entry.first, entry.second, err))
+  if (files_to_write.empty())
+    return true;
+
+  // Builds may list thousands of tests, most of them sharing the bulk of
+  // their dependencies, so index all of them at once and write the files on
+  // the worker pool.
+  std::vector<const Target*> roots;
+  for (const auto& entry : files_to_write)
+    roots.push_back(entry.second);
+  RuntimeDepsIndex index(roots);
+
+  // When a file is listed more than once the last entry wins, as if the
+  // files were written in order.
+  std::map<OutputFile, size_t> last_entry;
+  for (size_t i = 0; i < files_to_write.size(); i++)
+    last_entry[files_to_write[i].first] = i;
+
+  std::vector<Err> errs(files_to_write.size());
+  PendingPoolTasks pending;
+  for (size_t i = 0; i < files_to_write.size(); i++) {
+    if (last_entry[files_to_write[i].first] != i)
+      continue;
+    g_scheduler->PostPoolTask(
+        base::BindOnce(&WriteRuntimeDepsFile, &index, &files_to_write[i].first,
+                       files_to_write[i].second, &errs[i]),
+        &pending);
+  }
+  pending.Wait();
+
+  for (const Err& write_err : errs) {
+    if (write_err.has_error()) {
+      *err = write_err;
       return false;
+    }
   }
   return true;
 }
@@ -4,7 +4,10 @@
 
 #include <stddef.h>
 
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/stl_util.h"
+#include "tools/gn/builder.h"
 #include "tools/gn/runtime_deps.h"
 #include "tools/gn/scheduler.h"
 #include "tools/gn/target.h"
@@ -445,3 +448,49 @@ TEST_F(RuntimeDeps, WriteRuntimeDepsVariable) {
   EXPECT_EQ(1U, setup.items().size());
   EXPECT_EQ(1U, scheduler().GetWriteRuntimeDepsTargets().size());
 }
+
+// Tests writing the write_runtime_deps files on the worker pool.
+TEST_F(RuntimeDeps, WriteRuntimeDepsFiles) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  TestWithScope setup;
+  setup.build_settings()->SetRootPath(temp_dir.GetPath());
+  Err err;
+
+  Target first(setup.settings(), Label(SourceDir("//"), "first"));
+  InitTargetWithType(setup, &first, Target::GROUP);
+  first.data().push_back("//first.dat");
+  first.set_write_runtime_deps_output(OutputFile("first.runtime_deps"));
+  ASSERT_TRUE(first.OnResolved(&err));
+
+  Target second(setup.settings(), Label(SourceDir("//"), "second"));
+  InitTargetWithType(setup, &second, Target::GROUP);
+  second.data().push_back("//second.dat");
+  second.set_write_runtime_deps_output(OutputFile("second.runtime_deps"));
+  ASSERT_TRUE(second.OnResolved(&err));
+
+  // Writes the same file as |first|, after it.
+  Target last(setup.settings(), Label(SourceDir("//"), "last"));
+  InitTargetWithType(setup, &last, Target::GROUP);
+  last.data().push_back("//last.dat");
+  last.set_write_runtime_deps_output(OutputFile("first.runtime_deps"));
+  ASSERT_TRUE(last.OnResolved(&err));
+
+  scheduler().AddWriteRuntimeDepsTarget(&first);
+  scheduler().AddWriteRuntimeDepsTarget(&second);
+  scheduler().AddWriteRuntimeDepsTarget(&last);
+
+  Builder builder(nullptr);
+  ASSERT_TRUE(WriteRuntimeDepsFilesIfNecessary(builder, &err))
+      << err.message();
+
+  // The last entry for a file wins.
+  base::FilePath out_dir = temp_dir.GetPath().AppendASCII("out/Debug");
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(
+      out_dir.AppendASCII("first.runtime_deps"), &contents));
+  EXPECT_EQ("../../last.dat\n", contents);
+  ASSERT_TRUE(base::ReadFileToString(
+      out_dir.AppendASCII("second.runtime_deps"), &contents));
+  EXPECT_EQ("../../second.dat\n", contents);
+}
@@ -10,21 +10,50 @@
 #include "base/bind.h"
 #include "base/files/file_util.h"
 #include "tools/gn/filesystem_utils.h"
+#include "tools/gn/metadata_walk.h"
 #include "tools/gn/standard_out.h"
 #include "tools/gn/target.h"
+#include "tools/gn/trace.h"
+#include "util/sys_info.h"
 
 namespace {}  // namespace
 
+PendingPoolTasks::PendingPoolTasks() : pending_(0) {}
+
+PendingPoolTasks::~PendingPoolTasks() {
+  DCHECK_EQ(0, pending_);
+}
+
+void PendingPoolTasks::Add() {
+  std::lock_guard<std::mutex> lock(lock_);
+  pending_++;
+}
+
+void PendingPoolTasks::Done() {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (--pending_ == 0)
+    done_cv_.notify_all();
+}
+
+void PendingPoolTasks::Wait() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (pending_ > 0)
+    done_cv_.wait(lock);
+}
+
 Scheduler* g_scheduler = nullptr;
 
 Scheduler::Scheduler()
     : main_thread_run_loop_(MsgLoop::Current()),
       input_file_manager_(new InputFileManager),
+      metadata_walk_cache_(new MetadataWalkCache),
       verbose_logging_(false),
       verbose_log_file_(),
       env_logging_(false),
       pool_work_count_lock_(),
       pool_work_count_cv_(),
+      running_script_processes_(0),
+      max_script_processes_(std::max(NumberOfProcessors(), 8)),
       worker_pool_(),
       is_failed_(false),
       suppress_output_for_testing_(false),
@@ -95,9 +124,11 @@ void Scheduler::FailWithError(const Err& err) {
 void Scheduler::ScheduleWork(Task work) {
   IncrementWorkCount();
   pool_work_count_.Increment();
+  AddToTraceCounter(TRACE_COUNTER_POOL_WORK, 1);
   worker_pool_.PostTask(base::BindOnce(
       [](Scheduler* self, Task work) {
         std::move(work).Run();
+        AddToTraceCounter(TRACE_COUNTER_POOL_WORK, -1);
         self->DecrementWorkCount();
         if (!self->pool_work_count_.Decrement()) {
           std::unique_lock<std::mutex> auto_lock(self->pool_work_count_lock_);
@@ -107,6 +138,43 @@ void Scheduler::ScheduleWork(Task work) {
       this, std::move(work)));
 }
 
+void Scheduler::PostPoolTask(Task work) {
+  AddToTraceCounter(TRACE_COUNTER_POOL_WORK, 1);
+  worker_pool_.PostTask(base::BindOnce(
+      [](Task work) {
+        std::move(work).Run();
+        AddToTraceCounter(TRACE_COUNTER_POOL_WORK, -1);
+      },
+      std::move(work)));
+}
+
+void Scheduler::PostPoolTask(Task work, PendingPoolTasks* pending) {
+  pending->Add();
+  PostPoolTask(base::BindOnce(
+      [](PendingPoolTasks* pending, Task work) {
+        std::move(work).Run();
+        pending->Done();
+      },
+      pending, std::move(work)));
+}
+
+void Scheduler::BeginScriptProcess() {
+  std::unique_lock<std::mutex> lock(script_process_lock_);
+  while (running_script_processes_ >= max_script_processes_)
+    script_process_cv_.wait(lock);
+  running_script_processes_++;
+}
+
+void Scheduler::EndScriptProcess() {
+  std::unique_lock<std::mutex> lock(script_process_lock_);
+  running_script_processes_--;
+  script_process_cv_.notify_one();
+}
+
+WorkerPool::Stats Scheduler::GetWorkerPoolStats() const {
+  return worker_pool_.GetStats();
+}
+
 void Scheduler::AddGenDependency(const base::FilePath& file) {
   std::lock_guard<std::mutex> lock(lock_);
   gen_dependencies_.push_back(file);
@@ -8,11 +8,13 @@
 #include <fstream>
 #include <condition_variable>
 #include <map>
+#include <memory>
 #include <mutex>
 
 #include "base/atomic_ref_count.h"
 #include "base/files/file_path.h"
 #include "base/macros.h"
+#include "tools/gn/exec_script_cache.h"
 #include "tools/gn/input_file_manager.h"
 #include "tools/gn/label.h"
 #include "tools/gn/source_file.h"
@@ -21,8 +23,30 @@
 #include "util/task.h"
 #include "util/worker_pool.h"
 
+class MetadataWalkCache;
 class Target;
 
+// Counts the tasks posted with Scheduler::PostPoolTask() so that another
+// thread can wait for all of them.
+class PendingPoolTasks {
+ public:
+  PendingPoolTasks();
+  ~PendingPoolTasks();
+
+  void Add();
+  void Done();
+
+  // Blocks until every task that was added is done.
+  void Wait();
+
+ private:
+  std::mutex lock_;
+  std::condition_variable done_cv_;
+  int pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(PendingPoolTasks);
+};
+
 // Maintains the thread pool and error state.
 class Scheduler {
  public:
@@ -38,6 +62,12 @@ class Scheduler {
 
   InputFileManager* input_file_manager() { return input_file_manager_.get(); }
 
+  ExecScriptCache* exec_script_cache() { return &exec_script_cache_; }
+
+  MetadataWalkCache* metadata_walk_cache() {
+    return metadata_walk_cache_.get();
+  }
+
   bool verbose_logging() const { return verbose_logging_; }
   void set_verbose_logging(bool v) { verbose_logging_ = v; }
   void set_verbose_log(const base::FilePath& file_name);
@@ -56,6 +86,25 @@ class Scheduler {
 
   void ScheduleWork(Task work);
 
+  // Limits how many exec_script() processes run at the same time. Defaults
+  // to the number of processors, but at least 8 like the worker pool.
+  void set_max_script_processes(int max) { max_script_processes_ = max; }
+
+  // Waits until fewer than the maximum number of exec_script() processes are
+  // running and counts one more. Must be followed by EndScriptProcess().
+  void BeginScriptProcess();
+  void EndScriptProcess();
+
+  // Runs |work| on the same worker pool as ScheduleWork() but doesn't keep
+  // the message loop running, so it can also be used after Run() returns.
+  // The caller must wait for the work itself. The second version counts
+  // |work| in |pending| until it has run, for PendingPoolTasks::Wait().
+  void PostPoolTask(Task work);
+  void PostPoolTask(Task work, PendingPoolTasks* pending);
+
+  // Returns the usage counters of the worker pool running ScheduleWork tasks.
+  WorkerPool::Stats GetWorkerPoolStats() const;
+
   void Shutdown();
 
   // Declares that the given file was read and affected the build output.
@@ -121,6 +170,10 @@ class Scheduler {
 
   scoped_refptr<InputFileManager> input_file_manager_;
 
+  ExecScriptCache exec_script_cache_;
+
+  std::unique_ptr<MetadataWalkCache> metadata_walk_cache_;
+
   bool verbose_logging_;
   std::ofstream verbose_log_file_;
 
@@ -138,6 +191,12 @@ class Scheduler {
   // Condition variable signaled when |pool_work_count_| reaches zero.
   std::condition_variable pool_work_count_cv_;
 
+  // Protects |running_script_processes_|.
+  std::mutex script_process_lock_;
+  std::condition_variable script_process_cv_;
+  int running_script_processes_;
+  int max_script_processes_;
+
   WorkerPool worker_pool_;
 
   mutable std::mutex lock_;
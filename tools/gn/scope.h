@@ -16,6 +16,7 @@
 #include "base/memory/ref_counted.h"
 #include "tools/gn/err.h"
 #include "tools/gn/pattern.h"
+#include "tools/gn/small_map.h"
 #include "tools/gn/source_dir.h"
 #include "tools/gn/value.h"
 
@@ -338,7 +339,9 @@ class Scope {
     Value value;
   };
 
-  typedef std::unordered_map<base::StringPiece, Record, base::StringPieceHash>
+  // Most scopes (template invocations, foreach loops, target blocks) only
+  // hold a handful of variables, so keep those inline.
+  typedef SmallMap<base::StringPiece, Record, 16, base::StringPieceHash>
       RecordMap;
 
   void AddProvider(ProgrammaticProvider* p);
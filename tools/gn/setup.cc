@@ -16,6 +16,7 @@
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/memory/ref_counted.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
@@ -290,6 +291,8 @@ base::FilePath FindWindowsPython() {
 }  // namespace
 
 const char Setup::kBuildArgFileName[] = "args.gn";
+const char Setup::kParseCacheFileName[] = "gn_parse.cache";
+const char Setup::kExecScriptCacheFileName[] = "gn_exec_script.cache";
 
 Setup::Setup()
     : build_settings_(),
@@ -297,6 +300,7 @@ Setup::Setup()
       builder_(loader_.get()),
       root_build_file_("//BUILD.gn"),
       check_public_headers_(false),
+      include_scan_cache_(nullptr),
       dotfile_settings_(&build_settings_, std::string()),
       dotfile_scope_(&dotfile_settings_),
       default_args_(nullptr),
@@ -324,9 +328,25 @@ bool Setup::DoSetup(const std::string& build_dir,
                     const base::CommandLine& cmdline) {
   scheduler_.set_verbose_logging(cmdline.HasSwitch(switches::kVerbose));
   scheduler_.set_verbose_log(cmdline.GetSwitchValuePath(switches::kVerbose));
+  builder_.set_resolve_on_worker_pool(
+      cmdline.HasSwitch(switches::kParallelResolve));
+  if (cmdline.HasSwitch(switches::kExecScriptJobs)) {
+    int jobs = 0;
+    if (!base::StringToInt(
+            cmdline.GetSwitchValueASCII(switches::kExecScriptJobs), &jobs) ||
+        jobs < 1) {
+      Err(Location(), "Invalid --exec-script-jobs value.",
+          "Expected a positive number of processes.")
+          .PrintToStdout();
+      return false;
+    }
+    scheduler_.set_max_script_processes(jobs);
+  }
   if (cmdline.HasSwitch(switches::kTime) ||
       cmdline.HasSwitch(switches::kTracelog))
     EnableTracing();
+  if (cmdline.HasSwitch(switches::kTracelog))
+    StartSamplingTraceCounters();
 
   ScopedTrace setup_trace(TraceItem::TRACE_SETUP, "DoSetup");
 
@@ -341,6 +361,19 @@ bool Setup::DoSetup(const std::string& build_dir,
   if (!FillBuildDir(build_dir, !force_create))
     return false;
 
+  // Must be after FillBuildDir and before any build file is loaded. Imports of
+  // the dotfile were loaded by RunConfigFile() and aren't cached.
+  if (cmdline.HasSwitch(switches::kParseCache)) {
+    scheduler_.input_file_manager()->EnableParseCache(
+        build_settings_.GetFullPath(SourceFile(
+            build_settings_.build_dir().value() + kParseCacheFileName)));
+  }
+  if (cmdline.HasSwitch(switches::kExecScriptCache)) {
+    scheduler_.exec_script_cache()->EnableFileCache(
+        build_settings_.GetFullPath(SourceFile(
+            build_settings_.build_dir().value() + kExecScriptCacheFileName)));
+  }
+
   // Apply project-specific default (if specified).
   // Must happen before FillArguments().
   if (default_args_) {
@@ -374,6 +407,8 @@ bool Setup::Run(const base::CommandLine& cmdline) {
   RunPreMessageLoop();
   if (!scheduler_.Run())
     return false;
+  scheduler_.input_file_manager()->SaveParseCache();
+  scheduler_.exec_script_cache()->SaveFileCache();
   return RunPostMessageLoop(cmdline);
 }
 
@@ -419,7 +454,7 @@ bool Setup::RunPostMessageLoop(const base::CommandLine& cmdline) {
     }
 
     if (!commands::CheckPublicHeaders(&build_settings_, all_targets, to_check,
-                                      false, false)) {
+                                      false, false, include_scan_cache_)) {
       return false;
     }
   }
@@ -20,6 +20,7 @@
 #include "tools/gn/token.h"
 #include "tools/gn/toolchain.h"
 
+class IncludeScanCache;
 class InputFile;
 class ParseNode;
 
@@ -84,6 +85,12 @@ class Setup {
   // headers to be checked. Defaults to false.
   void set_check_public_headers(bool s) { check_public_headers_ = s; }
 
+  // The cache passed to the header check done by Run(), if it's enabled. If
+  // null, the check loads and saves the cache itself. The cache is not owned.
+  void set_include_scan_cache(IncludeScanCache* cache) {
+    include_scan_cache_ = cache;
+  }
+
   // Read from the .gn file, these are the targets to check. If the .gn file
   // does not specify anything, this will be null. If the .gn file specifies
   // the empty list, this will be non-null but empty.
@@ -101,6 +108,14 @@ class Setup {
   // arguments.
   static const char kBuildArgFileName[];
 
+  // Name of the file in the root build directory that holds the parse cache
+  // (see --parse-cache).
+  static const char kParseCacheFileName[];
+
+  // Name of the file in the root build directory that holds the exec_script()
+  // cache (see --exec-script-cache).
+  static const char kExecScriptCacheFileName[];
+
  private:
   // Performs the two sets of operations to run the generation before and after
   // the message loop is run.
@@ -145,6 +160,7 @@ class Setup {
   SourceFile root_build_file_;
 
   bool check_public_headers_;
+  IncludeScanCache* include_scan_cache_;
 
   // See getter for info.
   std::unique_ptr<std::vector<LabelPattern>> check_patterns_;
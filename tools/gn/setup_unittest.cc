@@ -43,3 +43,30 @@ TEST_F(SetupTest, DotGNFileIsGenDep) {
   ASSERT_EQ(1u, gen_deps.size());
   EXPECT_EQ(gen_deps[0], base::MakeAbsoluteFilePath(dot_gn_name));
 }
+
+TEST_F(SetupTest, ParseCacheWithDotfileImport) {
+  base::CommandLine cmdline(base::CommandLine::NO_PROGRAM);
+
+  // The .gn file imports a .gni, which is loaded before the parse cache can
+  // be enabled.
+  base::ScopedTempDir in_temp_dir;
+  ASSERT_TRUE(in_temp_dir.CreateUniqueTempDir());
+  base::FilePath in_path = in_temp_dir.GetPath();
+  WriteFile(in_path.Append(FILE_PATH_LITERAL(".gn")),
+            "import(\"//dotfile_settings.gni\")\n"
+            "buildconfig = \"//BUILDCONFIG.gn\"\n"
+            "exec_script_whitelist = settings_whitelist\n");
+  WriteFile(in_path.Append(FILE_PATH_LITERAL("dotfile_settings.gni")),
+            "settings_whitelist = [ \"//BUILD.gn\" ]\n");
+  WriteFile(in_path.Append(FILE_PATH_LITERAL("BUILDCONFIG.gn")), "");
+  cmdline.AppendSwitchASCII(switches::kRoot, FilePathToUTF8(in_path));
+  cmdline.AppendSwitch(switches::kParseCache);
+
+  base::ScopedTempDir build_temp_dir;
+  ASSERT_TRUE(build_temp_dir.CreateUniqueTempDir());
+
+  Setup setup;
+  EXPECT_TRUE(
+      setup.DoSetup(FilePathToUTF8(build_temp_dir.GetPath()), true, cmdline));
+  setup.scheduler().input_file_manager()->SaveParseCache();
+}
@@ -0,0 +1,199 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_SMALL_MAP_H_
+#define TOOLS_GN_SMALL_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/macros.h"
+
+// An unordered map for the common case of only a few entries.
+//
+// The first N entries are stored inline in the map and are found with a linear
+// search, so creating a map and doing lookups in it doesn't allocate or hash.
+// Entries beyond that go to an overflow std::unordered_map.
+//
+// Like std::unordered_map, entries never move once inserted, so pointers to
+// them remain valid until that entry is erased. Iteration visits the inline
+// entries in slot order followed by the overflow entries.
+template <typename Key, typename T, size_t N, typename Hash = std::hash<Key>>
+class SmallMap {
+ private:
+  using OverflowMap = std::unordered_map<Key, T, Hash>;
+
+ public:
+  using value_type = typename OverflowMap::value_type;
+
+  template <typename MapType, typename ValueType, typename OverflowIterator>
+  class IteratorBase {
+   public:
+    IteratorBase(MapType* map, size_t index, OverflowIterator overflow)
+        : map_(map), index_(index), overflow_(overflow) {}
+
+    ValueType& operator*() const {
+      return index_ < N ? *map_->slot(index_) : *overflow_;
+    }
+    ValueType* operator->() const { return &operator*(); }
+
+    IteratorBase& operator++() {
+      if (index_ < N) {
+        index_ = map_->NextOccupied(index_ + 1);
+        if (index_ == N)
+          overflow_ = map_->overflow_.begin();
+      } else {
+        ++overflow_;
+      }
+      return *this;
+    }
+
+    bool operator==(const IteratorBase& other) const {
+      return index_ == other.index_ &&
+             (index_ < N || overflow_ == other.overflow_);
+    }
+    bool operator!=(const IteratorBase& other) const {
+      return !operator==(other);
+    }
+
+   private:
+    friend class SmallMap;
+
+    MapType* map_;
+    size_t index_;  // Inline slot, or N when iterating the overflow map.
+    OverflowIterator overflow_;
+  };
+
+  using iterator =
+      IteratorBase<SmallMap, value_type, typename OverflowMap::iterator>;
+  using const_iterator = IteratorBase<const SmallMap,
+                                      const value_type,
+                                      typename OverflowMap::const_iterator>;
+
+  SmallMap() = default;
+  ~SmallMap() { clear(); }
+
+  bool empty() const { return size() == 0; }
+  size_t size() const { return inline_size_ + overflow_.size(); }
+
+  iterator begin() {
+    size_t index = NextOccupied(0);
+    return iterator(this, index, overflow_.begin());
+  }
+  iterator end() { return iterator(this, N, overflow_.end()); }
+  const_iterator begin() const {
+    size_t index = NextOccupied(0);
+    return const_iterator(this, index, overflow_.begin());
+  }
+  const_iterator end() const {
+    return const_iterator(this, N, overflow_.end());
+  }
+
+  iterator find(const Key& key) {
+    size_t index = FindInline(key);
+    if (index < N)
+      return iterator(this, index, overflow_.end());
+    return iterator(this, N, overflow_.find(key));
+  }
+  const_iterator find(const Key& key) const {
+    size_t index = FindInline(key);
+    if (index < N)
+      return const_iterator(this, index, overflow_.end());
+    return const_iterator(this, N, overflow_.find(key));
+  }
+
+  // Returns the value for the key, inserting a default-constructed one if
+  // it's not present.
+  T& operator[](const Key& key) {
+    iterator found = find(key);
+    if (found != end())
+      return found->second;
+    if (inline_size_ == N)
+      return overflow_[key];
+
+    // Reuse the first free slot.
+    size_t index = 0;
+    while (occupied_ & (1u << index))
+      index++;
+    new (&slots_[index]) value_type(std::piecewise_construct,
+                                    std::forward_as_tuple(key),
+                                    std::forward_as_tuple());
+    occupied_ |= 1u << index;
+    inline_size_++;
+    return slot(index)->second;
+  }
+
+  void erase(iterator it) {
+    DCHECK(it.map_ == this);
+    if (it.index_ < N) {
+      slot(it.index_)->~value_type();
+      occupied_ &= ~(1u << it.index_);
+      inline_size_--;
+    } else {
+      overflow_.erase(it.overflow_);
+    }
+  }
+
+  size_t erase(const Key& key) {
+    iterator found = find(key);
+    if (found == end())
+      return 0;
+    erase(found);
+    return 1;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < N; i++) {
+      if (occupied_ & (1u << i))
+        slot(i)->~value_type();
+    }
+    occupied_ = 0;
+    inline_size_ = 0;
+    overflow_.clear();
+  }
+
+ private:
+  static_assert(N > 0 && N <= 32, "Inline slots are tracked in a uint32_t");
+
+  value_type* slot(size_t index) {
+    return reinterpret_cast<value_type*>(&slots_[index]);
+  }
+  const value_type* slot(size_t index) const {
+    return reinterpret_cast<const value_type*>(&slots_[index]);
+  }
+
+  // Returns the first occupied inline slot at or after |index|, or N.
+  size_t NextOccupied(size_t index) const {
+    while (index < N && !(occupied_ & (1u << index)))
+      index++;
+    return index;
+  }
+
+  // Returns the inline slot holding |key|, or N.
+  size_t FindInline(const Key& key) const {
+    size_t i = 0;
+    for (uint32_t bits = occupied_; bits; bits >>= 1, i++) {
+      if ((bits & 1) && slot(i)->first == key)
+        return i;
+    }
+    return N;
+  }
+
+  uint32_t occupied_ = 0;  // Bit i is set when slots_[i] holds an entry.
+  size_t inline_size_ = 0;
+  typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type
+      slots_[N];
+  OverflowMap overflow_;
+
+  DISALLOW_COPY_AND_ASSIGN(SmallMap);
+};
+
+#endif  // TOOLS_GN_SMALL_MAP_H_
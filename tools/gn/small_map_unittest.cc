@@ -0,0 +1,51 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <set>
+#include <string>
+
+#include "tools/gn/small_map.h"
+#include "util/test/test.h"
+
+TEST(SmallMap, InlineAndOverflow) {
+  SmallMap<std::string, int, 2> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.begin() == map.end());
+
+  map["a"] = 1;
+  map["b"] = 2;
+  int* b = &map["b"];
+  map["c"] = 3;  // Overflow.
+  map["d"] = 4;
+  EXPECT_EQ(4u, map.size());
+
+  // Entries don't move when others are added.
+  EXPECT_EQ(b, &map["b"]);
+
+  EXPECT_EQ(1, map.find("a")->second);
+  EXPECT_EQ(3, map.find("c")->second);
+  EXPECT_TRUE(map.find("e") == map.end());
+
+  std::set<std::string> keys;
+  for (const auto& pair : map)
+    keys.insert(pair.first);
+  EXPECT_EQ((std::set<std::string>{"a", "b", "c", "d"}), keys);
+
+  // Erasing an inline entry frees its slot for the next insertion.
+  EXPECT_EQ(1u, map.erase("a"));
+  EXPECT_EQ(0u, map.erase("a"));
+  map["e"] = 5;
+  EXPECT_EQ(4u, map.size());
+  EXPECT_EQ(b, &map["b"]);
+
+  map.erase(map.find("c"));
+  keys.clear();
+  for (const auto& pair : map)
+    keys.insert(pair.first);
+  EXPECT_EQ((std::set<std::string>{"b", "d", "e"}), keys);
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.find("b") == map.end());
+}
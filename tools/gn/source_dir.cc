@@ -59,17 +59,21 @@ bool ValidateResolveInput(bool as_file,
 
 SourceDir::SourceDir() = default;
 
-SourceDir::SourceDir(const base::StringPiece& p) : value_(p.data(), p.size()) {
-  if (!EndsWithSlash(value_))
-    value_.push_back('/');
-  AssertValueSourceDirString(value_);
+SourceDir::SourceDir(const base::StringPiece& p) {
+  std::string value = p.as_string();
+  if (!EndsWithSlash(value))
+    value.push_back('/');
+  AssertValueSourceDirString(value);
+  value_ = StringAtom(value);
 }
 
 SourceDir::SourceDir(SwapIn, std::string* s) {
-  value_.swap(*s);
-  if (!EndsWithSlash(value_))
-    value_.push_back('/');
-  AssertValueSourceDirString(value_);
+  std::string value;
+  value.swap(*s);
+  if (!EndsWithSlash(value))
+    value.push_back('/');
+  AssertValueSourceDirString(value);
+  value_ = StringAtom(value);
 }
 
 SourceDir::~SourceDir() = default;
@@ -85,7 +89,7 @@ std::string SourceDir::ResolveRelativeAs(
                                         err)) {
     return std::string();
   }
-  return ResolveRelative(input_value, value_, as_file, source_root);
+  return ResolveRelative(input_value, value_.str(), as_file, source_root);
 }
 
 SourceFile SourceDir::ResolveRelativeFile(
@@ -101,7 +105,8 @@ SourceFile SourceDir::ResolveRelativeFile(
   if (!ValidateResolveInput<std::string>(true, p, input_string, err)) {
     return ret;
   }
-  ret.value_ = ResolveRelative(input_string, value_, true, source_root);
+  ret.value_ = StringAtom(
+      ResolveRelative(input_string, value_.str(), true, source_root));
   return ret;
 }
 
@@ -134,12 +139,14 @@ SourceDir SourceDir::ResolveRelativeDir(
 }
 
 base::FilePath SourceDir::Resolve(const base::FilePath& source_root) const {
-  return ResolvePath(value_, false, source_root);
+  return ResolvePath(value_.str(), false, source_root);
 }
 
 void SourceDir::SwapValue(std::string* v) {
-  value_.swap(*v);
-  AssertValueSourceDirString(value_);
+  StringAtom new_value(*v);
+  *v = value_.str();
+  value_ = new_value;
+  AssertValueSourceDirString(value_.str());
 }
 
 // Explicit template instantiation
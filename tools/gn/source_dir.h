@@ -9,10 +9,12 @@
 
 #include <algorithm>
 #include <string>
+#include <utility>
 
 #include "base/files/file_path.h"
 #include "base/logging.h"
 #include "base/strings/string_piece.h"
+#include "tools/gn/string_atom.h"
 
 class Err;
 class SourceFile;
@@ -25,6 +27,8 @@ class Value;
 // path. On Windows, absolute system paths will be of the form "/C:/foo/bar".
 //
 // Two slashes at the beginning indicate a path relative to the source root.
+//
+// Like SourceFile, the path is interned.
 class SourceDir {
  public:
   enum SwapIn { SWAP_IN };
@@ -78,8 +82,8 @@ class SourceDir {
       Err* err,
       const base::StringPiece& source_root = base::StringPiece()) const {
     SourceDir ret;
-    ret.value_ = ResolveRelativeAs<StringType>(false, blame_input_value,
-                                               input_value, err, source_root);
+    ret.value_ = StringAtom(ResolveRelativeAs<StringType>(
+        false, blame_input_value, input_value, err, source_root));
     return ret;
   }
 
@@ -95,12 +99,13 @@ class SourceDir {
   base::FilePath Resolve(const base::FilePath& source_root) const;
 
   bool is_null() const { return value_.empty(); }
-  const std::string& value() const { return value_; }
+  const std::string& value() const { return value_.str(); }
 
   // Returns true if this path starts with a "//" which indicates a path
   // from the source root.
   bool is_source_absolute() const {
-    return value_.size() >= 2 && value_[0] == '/' && value_[1] == '/';
+    const std::string& value = value_.str();
+    return value.size() >= 2 && value[0] == '/' && value[1] == '/';
   }
 
   // Returns true if this path starts with a single slash which indicates a
@@ -116,7 +121,7 @@ class SourceDir {
   // return value points into our buffer.
   base::StringPiece SourceAbsoluteWithOneSlash() const {
     CHECK(is_source_absolute());
-    return base::StringPiece(&value_[1], value_.size() - 1);
+    return base::StringPiece(&value()[1], value().size() - 1);
   }
 
   // Returns a path that does not end with a slash.
@@ -124,24 +129,28 @@ class SourceDir {
   // This function simply returns the reference to the value if the path is a
   // root, e.g. "/" or "//".
   base::StringPiece SourceWithNoTrailingSlash() const {
-    if (value_.size() > 2)
-      return base::StringPiece(&value_[0], value_.size() - 1);
-    return base::StringPiece(value_);
+    const std::string& value = value_.str();
+    if (value.size() > 2)
+      return base::StringPiece(&value[0], value.size() - 1);
+    return base::StringPiece(value);
   }
 
   void SwapValue(std::string* v);
 
+  // Precomputed hash of the path.
+  size_t hash() const { return value_.hash(); }
+
   bool operator==(const SourceDir& other) const {
     return value_ == other.value_;
   }
   bool operator!=(const SourceDir& other) const { return !operator==(other); }
   bool operator<(const SourceDir& other) const { return value_ < other.value_; }
 
-  void swap(SourceDir& other) { value_.swap(other.value_); }
+  void swap(SourceDir& other) { std::swap(value_, other.value_); }
 
  private:
   friend class SourceFile;
-  std::string value_;
+  StringAtom value_;
 
   // Copy & assign supported.
 };
@@ -150,10 +159,7 @@ namespace std {
 
 template <>
 struct hash<SourceDir> {
-  std::size_t operator()(const SourceDir& v) const {
-    hash<std::string> h;
-    return h(v.value());
-  }
+  std::size_t operator()(const SourceDir& v) const { return v.hash(); }
 };
 
 }  // namespace std
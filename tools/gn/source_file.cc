@@ -25,18 +25,21 @@ void AssertValueSourceFileString(const std::string& s) {
 
 SourceFile::SourceFile() = default;
 
-SourceFile::SourceFile(const base::StringPiece& p)
-    : value_(p.data(), p.size()) {
-  DCHECK(!value_.empty());
-  AssertValueSourceFileString(value_);
-  NormalizePath(&value_);
+SourceFile::SourceFile(const base::StringPiece& p) {
+  std::string value = p.as_string();
+  DCHECK(!value.empty());
+  AssertValueSourceFileString(value);
+  NormalizePath(&value);
+  value_ = StringAtom(value);
 }
 
 SourceFile::SourceFile(SwapIn, std::string* value) {
-  value_.swap(*value);
-  DCHECK(!value_.empty());
-  AssertValueSourceFileString(value_);
-  NormalizePath(&value_);
+  std::string swapped;
+  swapped.swap(*value);
+  DCHECK(!swapped.empty());
+  AssertValueSourceFileString(swapped);
+  NormalizePath(&swapped);
+  value_ = StringAtom(swapped);
 }
 
 SourceFile::~SourceFile() = default;
@@ -45,20 +48,22 @@ std::string SourceFile::GetName() const {
   if (is_null())
     return std::string();
 
-  DCHECK(value_.find('/') != std::string::npos);
-  size_t last_slash = value_.rfind('/');
-  return std::string(&value_[last_slash + 1], value_.size() - last_slash - 1);
+  const std::string& value = value_.str();
+  DCHECK(value.find('/') != std::string::npos);
+  size_t last_slash = value.rfind('/');
+  return std::string(&value[last_slash + 1], value.size() - last_slash - 1);
 }
 
 SourceDir SourceFile::GetDir() const {
   if (is_null())
     return SourceDir();
 
-  DCHECK(value_.find('/') != std::string::npos);
-  size_t last_slash = value_.rfind('/');
-  return SourceDir(base::StringPiece(&value_[0], last_slash + 1));
+  const std::string& value = value_.str();
+  DCHECK(value.find('/') != std::string::npos);
+  size_t last_slash = value.rfind('/');
+  return SourceDir(base::StringPiece(&value[0], last_slash + 1));
 }
 
 base::FilePath SourceFile::Resolve(const base::FilePath& source_root) const {
-  return ResolvePath(value_, true, source_root);
+  return ResolvePath(value_.str(), true, source_root);
 }
@@ -9,15 +9,20 @@
 
 #include <algorithm>
 #include <string>
+#include <utility>
 
 #include "base/files/file_path.h"
 #include "base/logging.h"
 #include "base/strings/string_piece.h"
+#include "tools/gn/string_atom.h"
 
 class SourceDir;
 
 // Represents a file within the source tree. Always begins in a slash, never
 // ends in one.
+//
+// The path is interned (see StringAtom), so copies are cheap and comparing
+// two files for equality doesn't look at the strings.
 class SourceFile {
  public:
   enum SwapIn { SWAP_IN };
@@ -35,7 +40,7 @@ class SourceFile {
   ~SourceFile();
 
   bool is_null() const { return value_.empty(); }
-  const std::string& value() const { return value_; }
+  const std::string& value() const { return value_.str(); }
 
   // Returns everything after the last slash.
   std::string GetName() const;
@@ -48,7 +53,8 @@ class SourceFile {
   // Returns true if this file starts with a "//" which indicates a path
   // from the source root.
   bool is_source_absolute() const {
-    return value_.size() >= 2 && value_[0] == '/' && value_[1] == '/';
+    const std::string& value = value_.str();
+    return value.size() >= 2 && value[0] == '/' && value[1] == '/';
   }
 
   // Returns true if this file starts with a single slash which indicates a
@@ -63,9 +69,12 @@ class SourceFile {
   // return value points into our buffer.
   base::StringPiece SourceAbsoluteWithOneSlash() const {
     CHECK(is_source_absolute());
-    return base::StringPiece(&value_[1], value_.size() - 1);
+    return base::StringPiece(&value()[1], value().size() - 1);
   }
 
+  // Precomputed hash of the path.
+  size_t hash() const { return value_.hash(); }
+
   bool operator==(const SourceFile& other) const {
     return value_ == other.value_;
   }
@@ -74,12 +83,12 @@ class SourceFile {
     return value_ < other.value_;
   }
 
-  void swap(SourceFile& other) { value_.swap(other.value_); }
+  void swap(SourceFile& other) { std::swap(value_, other.value_); }
 
  private:
   friend class SourceDir;
 
-  std::string value_;
+  StringAtom value_;
 
   // Copy & assign supported.
 };
@@ -88,10 +97,7 @@ namespace std {
 
 template <>
 struct hash<SourceFile> {
-  std::size_t operator()(const SourceFile& v) const {
-    hash<std::string> h;
-    return h(v.value());
-  }
+  std::size_t operator()(const SourceFile& v) const { return v.hash(); }
 };
 
 }  // namespace std
@@ -38,6 +38,9 @@ bool is_markdown = false;
 // True while output is going into a markdown ```...``` code block.
 bool in_body = false;
 
+// See SetOutputCapture().
+std::string* output_capture = nullptr;
+
 void EnsureInitialized() {
   if (initialized)
     return;
@@ -72,6 +75,10 @@ void EnsureInitialized() {
 
 #if !defined(OS_WIN)
 void WriteToStdOut(const std::string& output) {
+  if (output_capture) {
+    output_capture->append(output);
+    return;
+  }
   size_t written_bytes = fwrite(output.data(), 1, output.size(), stdout);
   DCHECK_EQ(output.size(), written_bytes);
 }
@@ -97,6 +104,10 @@ void OutputMarkdownDec(TextDecoration dec) {
 
 }  // namespace
 
+void SetOutputCapture(std::string* capture) {
+  output_capture = capture;
+}
+
 bool IsColorConsole() {
     EnsureInitialized();
     return is_console;
@@ -108,6 +119,10 @@ void OutputString(const std::string& output,
                   TextDecoration dec,
                   HtmlEscaping escaping) {
   EnsureInitialized();
+  if (output_capture) {
+    output_capture->append(output);
+    return;
+  }
   DWORD written = 0;
 
   if (is_markdown) {
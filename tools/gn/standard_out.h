@@ -29,6 +29,12 @@ void OutputString(const std::string& output,
                   TextDecoration dec = DECORATION_NONE,
                   HtmlEscaping = DEFAULT_ESCAPING);
 
+// Appends everything written by the functions in this file to |capture|
+// instead of writing it to the standard output, until this is called again
+// with null. Used by "gn server" to send the output of a command to its
+// client. Must only be used from the main thread.
+void SetOutputCapture(std::string* capture);
+
 // If printing markdown, this generates table-of-contents entries with
 // links to the actual help; otherwise, prints a one-line description.
 void PrintSectionHelp(const std::string& line,
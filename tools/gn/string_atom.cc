@@ -0,0 +1,59 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/string_atom.h"
+
+#include <functional>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+#include "tools/gn/arena.h"
+
+namespace {
+
+// The table is split into independently locked shards so that threads
+// interning different strings rarely wait on each other.
+const size_t kShardCount = 64;
+
+const size_t kShardArenaBlockSize = 64 * 1024;
+
+}  // namespace
+
+const StringAtom::Entry StringAtom::empty_entry_ = {
+    std::string(), std::hash<std::string>()(std::string())};
+
+// static
+const StringAtom::Entry* StringAtom::Intern(const base::StringPiece& str) {
+  if (str.empty())
+    return &empty_entry_;
+
+  struct Shard {
+    Shard() : arena(kShardArenaBlockSize) {}
+
+    std::mutex lock;
+
+    // The keys point to the strings of the entries.
+    std::unordered_map<base::StringPiece, const Entry*, base::StringPieceHash>
+        entries;
+
+    // Holds the entries, which are never freed.
+    Arena arena;
+  };
+  // Leaked intentionally, the atoms must stay valid until exit.
+  static Shard* shards = new Shard[kShardCount];
+
+  Shard& shard = shards[base::StringPieceHash()(str) % kShardCount];
+  std::lock_guard<std::mutex> lock(shard.lock);
+  auto found = shard.entries.find(str);
+  if (found != shard.entries.end())
+    return found->second;
+
+  Entry* entry =
+      new (shard.arena.Allocate(sizeof(Entry), alignof(Entry))) Entry;
+  entry->str = str.as_string();
+  entry->hash = std::hash<std::string>()(entry->str);
+  shard.entries.emplace(base::StringPiece(entry->str), entry);
+  return entry;
+}
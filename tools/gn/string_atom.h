@@ -0,0 +1,62 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_STRING_ATOM_H_
+#define TOOLS_GN_STRING_ATOM_H_
+
+#include <stddef.h>
+
+#include <string>
+
+#include "base/strings/string_piece.h"
+
+// An interned string. All atoms with the same contents point to one shared
+// copy of the string that lives until the process exits. This makes an atom
+// pointer-sized and cheap to copy, and equality is a pointer comparison.
+//
+// The hash is computed once when the string is interned. It's the same as
+// std::hash<std::string> of the contents, so hashed containers keep the
+// iteration order they had with plain strings.
+//
+// Atoms can be created on any thread.
+class StringAtom {
+ public:
+  // The empty string.
+  StringAtom() : entry_(&empty_entry_) {}
+
+  explicit StringAtom(const base::StringPiece& str) : entry_(Intern(str)) {}
+
+  const std::string& str() const { return entry_->str; }
+  bool empty() const { return entry_->str.empty(); }
+  size_t hash() const { return entry_->hash; }
+
+  bool operator==(const StringAtom& other) const {
+    return entry_ == other.entry_;
+  }
+  bool operator!=(const StringAtom& other) const {
+    return entry_ != other.entry_;
+  }
+
+  // Compares the contents rather than the addresses so that sorting is
+  // deterministic.
+  bool operator<(const StringAtom& other) const {
+    return entry_ != other.entry_ && entry_->str < other.entry_->str;
+  }
+
+ private:
+  struct Entry {
+    std::string str;
+    size_t hash;
+  };
+
+  static const Entry* Intern(const base::StringPiece& str);
+
+  static const Entry empty_entry_;
+
+  const Entry* entry_;
+
+  // Copy & assign supported.
+};
+
+#endif  // TOOLS_GN_STRING_ATOM_H_
@@ -0,0 +1,56 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tools/gn/string_atom.h"
+#include "util/test/test.h"
+
+TEST(StringAtom, Basic) {
+  StringAtom empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ("", empty.str());
+  EXPECT_EQ(empty, StringAtom(""));
+
+  std::string foo_string("foo");
+  StringAtom foo(foo_string);
+  EXPECT_FALSE(foo.empty());
+  EXPECT_EQ("foo", foo.str());
+  EXPECT_EQ(std::hash<std::string>()("foo"), foo.hash());
+
+  // Equal contents share one string.
+  StringAtom foo2("foo");
+  EXPECT_EQ(foo, foo2);
+  EXPECT_EQ(&foo.str(), &foo2.str());
+
+  StringAtom bar("bar");
+  EXPECT_NE(foo, bar);
+  EXPECT_TRUE(bar < foo);
+  EXPECT_FALSE(foo < bar);
+  EXPECT_FALSE(foo < foo2);
+}
+
+TEST(StringAtom, Threads) {
+  // Interning the same strings on several threads gives the same atoms.
+  const int kThreadCount = 4;
+  const int kStringCount = 1000;
+  std::vector<std::vector<StringAtom>> atoms(kThreadCount);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; i++) {
+    threads.emplace_back([&atoms, i]() {
+      for (int j = 0; j < kStringCount; j++)
+        atoms[i].push_back(StringAtom("//thread/" + std::to_string(j)));
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  for (int i = 1; i < kThreadCount; i++) {
+    for (int j = 0; j < kStringCount; j++)
+      EXPECT_EQ(atoms[0][j], atoms[i][j]);
+  }
+}
@@ -0,0 +1,130 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/string_output_buffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "tools/gn/err.h"
+#include "tools/gn/filesystem_utils.h"
+#include "tools/gn/trace.h"
+
+StringOutputBuffer::StringOutputBuffer() = default;
+
+StringOutputBuffer::~StringOutputBuffer() = default;
+
+size_t StringOutputBuffer::size() const {
+  if (pages_.empty())
+    return 0;
+  return (pages_.size() - 1) * kPageSize + (pptr() - pbase());
+}
+
+std::string StringOutputBuffer::str() const {
+  std::string result;
+  result.reserve(size());
+  for (size_t i = 0; i < pages_.size(); i++)
+    result.append(pages_[i]->data(), PageSize(i));
+  return result;
+}
+
+void StringOutputBuffer::Append(const char* data, size_t size) {
+  while (size > 0) {
+    if (pptr() == epptr())
+      AddPage();
+    size_t chunk = std::min(size, static_cast<size_t>(epptr() - pptr()));
+    memcpy(pptr(), data, chunk);
+    pbump(static_cast<int>(chunk));
+    data += chunk;
+    size -= chunk;
+  }
+}
+
+bool StringOutputBuffer::ContentsEqual(const base::FilePath& file_path) const {
+  base::File file(file_path, base::File::FLAG_OPEN | base::File::FLAG_READ |
+                                 base::File::FLAG_SEQUENTIAL_SCAN);
+  if (!file.IsValid())
+    return false;
+
+  int64_t file_size = file.GetLength();
+  if (file_size < 0 || static_cast<uint64_t>(file_size) != size())
+    return false;
+
+  // Compare one page at a time, stopping at the first difference.
+  std::unique_ptr<Page> file_page(new Page);
+  for (size_t i = 0; i < pages_.size(); i++) {
+    int page_size = static_cast<int>(PageSize(i));
+    if (file.ReadAtCurrentPos(file_page->data(), page_size) != page_size ||
+        memcmp(file_page->data(), pages_[i]->data(), page_size) != 0)
+      return false;
+  }
+  return true;
+}
+
+bool StringOutputBuffer::WriteToFile(const base::FilePath& file_path,
+                                     Err* err) const {
+  // Create the directory if necessary.
+  if (!base::CreateDirectory(file_path.DirName())) {
+    if (err) {
+      *err =
+          Err(Location(), "Unable to create directory.",
+              "I was using \"" + FilePathToUTF8(file_path.DirName()) + "\".");
+    }
+    return false;
+  }
+
+  base::File file(file_path,
+                  base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+  bool write_success = file.IsValid();
+  for (size_t i = 0; write_success && i < pages_.size(); i++) {
+    int page_size = static_cast<int>(PageSize(i));
+    write_success =
+        file.WriteAtCurrentPos(pages_[i]->data(), page_size) == page_size;
+  }
+
+  if (write_success) {
+    AddToTraceCounter(TRACE_COUNTER_BYTES_WRITTEN, size());
+  } else if (err) {
+    *err = Err(Location(), "Unable to write file.",
+               "I was writing \"" + FilePathToUTF8(file_path) + "\".");
+  }
+  return write_success;
+}
+
+bool StringOutputBuffer::WriteToFileIfChanged(const base::FilePath& file_path,
+                                              Err* err) const {
+  if (ContentsEqual(file_path))
+    return true;
+  return WriteToFile(file_path, err);
+}
+
+StringOutputBuffer::int_type StringOutputBuffer::overflow(int_type ch) {
+  if (traits_type::eq_int_type(ch, traits_type::eof()))
+    return traits_type::not_eof(ch);
+  AddPage();
+  *pptr() = traits_type::to_char_type(ch);
+  pbump(1);
+  return ch;
+}
+
+std::streamsize StringOutputBuffer::xsputn(const char* s, std::streamsize n) {
+  Append(s, static_cast<size_t>(n));
+  return n;
+}
+
+void StringOutputBuffer::AddPage() {
+  pages_.emplace_back(new Page);
+  char* begin = pages_.back()->data();
+  setp(begin, begin + kPageSize);
+}
+
+size_t StringOutputBuffer::PageSize(size_t i) const {
+  if (i + 1 < pages_.size())
+    return kPageSize;
+  return pptr() - pbase();
+}
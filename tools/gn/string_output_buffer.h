@@ -0,0 +1,85 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_STRING_OUTPUT_BUFFER_H_
+#define TOOLS_GN_STRING_OUTPUT_BUFFER_H_
+
+#include <stddef.h>
+
+#include <array>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+
+class Err;
+
+namespace base {
+class FilePath;
+}
+
+// An append-only buffer for generated file contents, used in place of a
+// std::stringstream by the ninja writers.
+//
+// Data is stored in fixed-size pages, so appending never moves what was
+// written before, and the contents can be compared with or written to a file
+// without first being copied into one string. It is a std::streambuf, so the
+// writers keep writing through a std::ostream:
+//
+//   StringOutputBuffer storage;
+//   std::ostream out(&storage);
+//   out << "rule cc\n";
+//   storage.WriteToFileIfChanged(path, &err);
+//
+// This only replaces the storage of a std::stringstream: writes still go
+// through std::ostream and xsputn() like with any other streambuf.
+class StringOutputBuffer : public std::streambuf {
+ public:
+  static const size_t kPageSize = 64 * 1024;
+
+  StringOutputBuffer();
+  ~StringOutputBuffer() override;
+
+  // Number of bytes written.
+  size_t size() const;
+
+  // Returns a copy of the contents.
+  std::string str() const;
+
+  void Append(const char* data, size_t size);
+  void Append(const std::string& str) { Append(str.data(), str.size()); }
+
+  // Returns true if the file at |file_path| has exactly these contents.
+  bool ContentsEqual(const base::FilePath& file_path) const;
+
+  // Writes the contents to the given file, creating its directory if
+  // necessary. Returns false and sets |err| (if not null) on failure.
+  bool WriteToFile(const base::FilePath& file_path, Err* err) const;
+
+  // Like WriteToFile(), but doesn't touch the file when ContentsEqual().
+  bool WriteToFileIfChanged(const base::FilePath& file_path, Err* err) const;
+
+ protected:
+  // std::streambuf implementation.
+  int_type overflow(int_type ch) override;
+  std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+ private:
+  using Page = std::array<char, kPageSize>;
+
+  // Appends a new page and makes it the put area.
+  void AddPage();
+
+  // Number of bytes used in page |i|.
+  size_t PageSize(size_t i) const;
+
+  // All but the last page are full. The last page is the put area.
+  std::vector<std::unique_ptr<Page>> pages_;
+
+  DISALLOW_COPY_AND_ASSIGN(StringOutputBuffer);
+};
+
+#endif  // TOOLS_GN_STRING_OUTPUT_BUFFER_H_
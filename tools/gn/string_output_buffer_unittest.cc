@@ -0,0 +1,90 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/string_output_buffer.h"
+
+#include <ostream>
+#include <string>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "util/test/test.h"
+
+namespace {
+
+// Returns a string spanning several pages with no repeating page contents.
+std::string MakeLongString() {
+  std::string result;
+  for (size_t i = 0; result.size() < 3 * StringOutputBuffer::kPageSize; i++)
+    result += std::to_string(i) + " ";
+  return result;
+}
+
+}  // namespace
+
+TEST(StringOutputBuffer, Append) {
+  StringOutputBuffer storage;
+  EXPECT_EQ(0u, storage.size());
+  EXPECT_EQ("", storage.str());
+
+  std::ostream out(&storage);
+  out << "foo" << ' ' << 42;
+  storage.Append(std::string(" bar"));
+  out << std::endl;
+  EXPECT_EQ(11u, storage.size());
+  EXPECT_EQ("foo 42 bar\n", storage.str());
+}
+
+TEST(StringOutputBuffer, CrossesPages) {
+  const std::string data = MakeLongString();
+
+  // One character at a time, which goes through the inline put area and
+  // overflow().
+  StringOutputBuffer by_char;
+  std::ostream out(&by_char);
+  for (char c : data)
+    out.put(c);
+  EXPECT_EQ(data.size(), by_char.size());
+  EXPECT_EQ(data, by_char.str());
+
+  // One big write, which goes through xsputn().
+  StringOutputBuffer by_block;
+  by_block.Append(std::string(5, 'x'));
+  by_block.Append(data);
+  EXPECT_EQ(data.size() + 5, by_block.size());
+  EXPECT_EQ(std::string(5, 'x') + data, by_block.str());
+}
+
+TEST(StringOutputBuffer, WriteToFileIfChanged) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath file_path =
+      temp_dir.GetPath().AppendASCII("dir").AppendASCII("foo.ninja");
+
+  const std::string data = MakeLongString();
+  StringOutputBuffer storage;
+  storage.Append(data);
+  EXPECT_FALSE(storage.ContentsEqual(file_path));
+
+  // Creates the directory and the file.
+  EXPECT_TRUE(storage.WriteToFileIfChanged(file_path, nullptr));
+  std::string file_data;
+  ASSERT_TRUE(base::ReadFileToString(file_path, &file_data));
+  EXPECT_EQ(data, file_data);
+  EXPECT_TRUE(storage.ContentsEqual(file_path));
+
+  // The same size but different contents on the last page.
+  StringOutputBuffer changed;
+  changed.Append(data.substr(0, data.size() - 1) + "!");
+  EXPECT_FALSE(changed.ContentsEqual(file_path));
+  EXPECT_TRUE(changed.WriteToFileIfChanged(file_path, nullptr));
+  ASSERT_TRUE(base::ReadFileToString(file_path, &file_data));
+  EXPECT_EQ(changed.str(), file_data);
+
+  // An empty buffer writes an empty file.
+  StringOutputBuffer empty;
+  EXPECT_FALSE(empty.ContentsEqual(file_path));
+  EXPECT_TRUE(empty.WriteToFile(file_path, nullptr));
+  EXPECT_TRUE(empty.ContentsEqual(file_path));
+}
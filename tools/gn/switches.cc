@@ -65,6 +65,47 @@ const char kDotfile_Help[] =
   use a different file.
 )";
 
+const char kExecScriptCache[] = "exec-script-cache";
+const char kExecScriptCache_HelpShort[] =
+    "--exec-script-cache: Reuse exec_script() output from earlier runs.";
+const char kExecScriptCache_Help[] =
+    R"(--exec-script-cache: Reuse exec_script() output from earlier runs.
+
+  Keeps the output of every exec_script() call that succeeded in the file
+  "gn_exec_script.cache" in the build directory. On the next run with this
+  switch, a call with the same command line reuses the kept output instead of
+  running the script, as long as the contents of the script and of its
+  file_dependencies are unchanged.
+
+  Only use this when the output of the scripts depends on nothing but their
+  arguments and the files they list. Entries for calls that were not made
+  during a run are removed from the cache.
+
+Examples
+
+  gn gen out/Default --exec-script-cache
+)";
+
+const char kExecScriptJobs[] = "exec-script-jobs";
+const char kExecScriptJobs_HelpShort[] =
+    "--exec-script-jobs: Limit exec_script() processes running at once.";
+const char kExecScriptJobs_Help[] =
+    R"(--exec-script-jobs: Limit exec_script() processes running at once.
+
+  Build files are loaded in parallel, so several exec_script() calls can run
+  their scripts at the same time. While a worker thread waits for a script,
+  another thread takes over its other work, so slow scripts don't hold up the
+  rest of the load.
+
+  The parameter is the maximum number of script processes running at once.
+  Further calls wait for one of them to finish. Defaults to the number of
+  processors, but at least 8.
+
+Examples
+
+  gn gen out/Default --exec-script-jobs=4
+)";
+
 const char kFailOnUnusedArgs[] = "fail-on-unused-args";
 const char kFailOnUnusedArgs_HelpShort[] =
     "--fail-on-unused-args: Treat unused build args as fatal errors.";
@@ -144,6 +185,45 @@ const char kMetaRebaseFiles_Help[] =
   contain only lists of strings, which will be interpreted as file names.
 )";
 
+const char kParallelResolve[] = "parallel-resolve";
+const char kParallelResolve_HelpShort[] =
+    "--parallel-resolve: Resolve targets on the worker threads.";
+const char kParallelResolve_Help[] =
+    R"(--parallel-resolve: Resolve targets on the worker threads.
+
+  Normally, once all dependencies of a target are known, the target is
+  resolved on the main thread. This includes pulling configs and libraries
+  from its dependencies and computing its output files.
+
+  With this switch, targets whose dependencies are all resolved are resolved
+  on the worker threads instead, so that independent targets are resolved in
+  parallel. The dependency bookkeeping still happens on the main thread.
+
+Examples
+
+  gn gen out/Default --parallel-resolve
+)";
+
+const char kParseCache[] = "parse-cache";
+const char kParseCache_HelpShort[] =
+    "--parse-cache: Cache parsed build files in the build directory.";
+const char kParseCache_Help[] =
+    R"(--parse-cache: Cache parsed build files in the build directory.
+
+  Keeps the tokens and parse trees of all loaded .gn and .gni files in the
+  file "gn_parse.cache" in the build directory. On the next run with this
+  switch, files whose contents are unchanged are not tokenized or parsed
+  again. Files are still read from disk and their contents are compared by
+  size and MD5 digest, so a stale cache entry is never used.
+
+  Entries for files that were not loaded during a run are removed from the
+  cache.
+
+Examples
+
+  gn gen out/Default --parse-cache
+)";
+
 const char kQuiet[] = "q";
 const char kQuiet_HelpShort[] =
     "-q: Quiet mode. Don't print output on success.";
@@ -217,7 +297,8 @@ const char kThreads_Help[] =
   it affects performance.
 
   The parameter is the number of worker threads. This does not count the main
-  thread (so there are always at least two).
+  thread (so there are always at least two), nor the threads started to stand
+  in for workers waiting on exec_script() processes.
 
 Examples
 
@@ -246,6 +327,11 @@ const char kTracelog_Help[] =
   The trace log will show file loads, executions, scripts, and writes. This
   allows performance analysis of the generation step.
 
+  Each thread gets its own lane. The log also has counters sampled during
+  the run (worker pool tasks, BuilderRecords waiting to be resolved, bytes
+  written and resident memory) and flow arrows that follow each target from
+  the load of its build file to the write of its ninja rules.
+
   To view the trace, open Chrome and navigate to "chrome://tracing/", then
   press "Load" and specify the file you passed to this parameter.
 
@@ -295,9 +381,13 @@ const SwitchInfoMap& GetSwitches() {
     INSERT_VARIABLE(Args)
     INSERT_VARIABLE(Color)
     INSERT_VARIABLE(Dotfile)
+    INSERT_VARIABLE(ExecScriptCache)
+    INSERT_VARIABLE(ExecScriptJobs)
     INSERT_VARIABLE(FailOnUnusedArgs)
     INSERT_VARIABLE(Markdown)
     INSERT_VARIABLE(NoColor)
+    INSERT_VARIABLE(ParallelResolve)
+    INSERT_VARIABLE(ParseCache)
     INSERT_VARIABLE(Root)
     INSERT_VARIABLE(Quiet)
     INSERT_VARIABLE(RuntimeDepsListFile)
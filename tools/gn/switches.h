@@ -39,6 +39,14 @@ extern const char kDotfile[];
 extern const char kDotfile_HelpShort[];
 extern const char kDotfile_Help[];
 
+extern const char kExecScriptCache[];
+extern const char kExecScriptCache_HelpShort[];
+extern const char kExecScriptCache_Help[];
+
+extern const char kExecScriptJobs[];
+extern const char kExecScriptJobs_HelpShort[];
+extern const char kExecScriptJobs_Help[];
+
 extern const char kFailOnUnusedArgs[];
 extern const char kFailOnUnusedArgs_HelpShort[];
 extern const char kFailOnUnusedArgs_Help[];
@@ -63,6 +71,14 @@ extern const char kNoColor[];
 extern const char kNoColor_HelpShort[];
 extern const char kNoColor_Help[];
 
+extern const char kParallelResolve[];
+extern const char kParallelResolve_HelpShort[];
+extern const char kParallelResolve_Help[];
+
+extern const char kParseCache[];
+extern const char kParseCache_HelpShort[];
+extern const char kParseCache_Help[];
+
 extern const char kScriptExecutable[];
 extern const char kScriptExecutable_HelpShort[];
 extern const char kScriptExecutable_Help[];
@@ -15,6 +15,7 @@
 #include "tools/gn/deps_iterator.h"
 #include "tools/gn/filesystem_utils.h"
 #include "tools/gn/functions.h"
+#include "tools/gn/metadata_walk.h"
 #include "tools/gn/scheduler.h"
 #include "tools/gn/source_file_type.h"
 #include "tools/gn/substitution_writer.h"
@@ -193,6 +194,76 @@ bool RecursiveCheckAssertNoDeps(const Target* target,
   return true;
 }
 
+// Collects the metadata of |target| itself and finds the deps to walk next.
+bool GetMetadataStep(const Target* target,
+                     const std::vector<std::string>& keys_to_extract,
+                     const std::vector<std::string>& keys_to_walk,
+                     const SourceDir& rebase_dir,
+                     bool deps_only,
+                     MetadataWalkSteps::Step* step,
+                     Err* err) {
+  std::vector<Value> next_walk_keys;
+  // If deps_only, this is the top-level target and thus we don't want to
+  // collect its metadata, only that of its deps and data_deps.
+  if (deps_only) {
+    // Empty string will be converted below to mean all deps and data_deps.
+    // Origin is null because this isn't declared anywhere, and should never
+    // trigger any errors.
+    next_walk_keys.push_back(Value(nullptr, ""));
+  } else {
+    // Otherwise, we walk this target and collect the appropriate data.
+    if (!target->metadata().WalkStep(target->settings()->build_settings(),
+                                     keys_to_extract, keys_to_walk,
+                                     rebase_dir, &next_walk_keys,
+                                     &step->values, err))
+      return false;
+  }
+
+  // Gather walk keys and find the appropriate target. Targets identified in
+  // the walk key set must be deps or data_deps of the declaring target.
+  const DepsIteratorRange& all_deps = target->GetDeps(Target::DEPS_ALL);
+  for (const auto& next : next_walk_keys) {
+    DCHECK(next.type() == Value::STRING);
+
+    // If we hit an empty string in this list, add all deps and data_deps. The
+    // ordering in the resulting list of values as a result will be the data
+    // from each explicitly listed dep prior to this, followed by all data in
+    // walk order of the remaining deps.
+    if (next.string_value().empty()) {
+      for (const auto& dep : all_deps)
+        step->next.push_back(dep.ptr);
+
+      // Any other walk keys are superfluous, as they can only be a subset of
+      // all deps.
+      break;
+    }
+
+    // Otherwise, look through the target's deps for the specified one.
+    bool found_next = false;
+    for (const auto& dep : all_deps) {
+      // Match against the label with the toolchain.
+      if (dep.label.GetUserVisibleName(true) == next.string_value()) {
+        step->next.push_back(dep.ptr);
+        // We found it, so we can exit this search now.
+        found_next = true;
+        break;
+      }
+    }
+    // If we didn't find the specified dep in the target, that's an error.
+    // Propagate it back to the user.
+    if (!found_next) {
+      *err = Err(next.origin(),
+                 std::string("I was expecting ") + next.string_value() +
+                     std::string(" to be a dependency of ") +
+                     target->label().GetUserVisibleName(true) +
+                     ". Make sure it's included in the deps or data_deps, and "
+                     "that you've specified the appropriate toolchain.");
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 const char kExecution_Help[] =
@@ -968,79 +1039,41 @@ bool Target::GetMetadata(const std::vector<std::string>& keys_to_extract,
                          std::vector<Value>* result,
                          std::set<const Target*>* targets_walked,
                          Err* err) const {
-  std::vector<Value> next_walk_keys;
-  std::vector<Value> current_result;
-  // If deps_only, this is the top-level target and thus we don't want to
-  // collect its metadata, only that of its deps and data_deps.
-  if (deps_only) {
-    // Empty string will be converted below to mean all deps and data_deps.
-    // Origin is null because this isn't declared anywhere, and should never
-    // trigger any errors.
-    next_walk_keys.push_back(Value(nullptr, ""));
-  } else {
-    // Otherwise, we walk this target and collect the appropriate data.
-    if (!metadata_.WalkStep(settings()->build_settings(), keys_to_extract,
-                            keys_to_walk, rebase_dir, &next_walk_keys,
-                            &current_result, err))
+  return GetMetadata(keys_to_extract, keys_to_walk, rebase_dir, deps_only,
+                     nullptr, result, targets_walked, err);
+}
+
+bool Target::GetMetadata(const std::vector<std::string>& keys_to_extract,
+                         const std::vector<std::string>& keys_to_walk,
+                         const SourceDir& rebase_dir,
+                         bool deps_only,
+                         MetadataWalkSteps* steps,
+                         std::vector<Value>* result,
+                         std::set<const Target*>* targets_walked,
+                         Err* err) const {
+  // The top-level target of a deps_only walk takes a different step, so it
+  // isn't shared.
+  bool use_steps = steps && !deps_only;
+  const MetadataWalkSteps::Step* step =
+      use_steps ? steps->Find(this) : nullptr;
+  std::unique_ptr<MetadataWalkSteps::Step> own_step;
+  if (!step) {
+    own_step = std::make_unique<MetadataWalkSteps::Step>();
+    if (!GetMetadataStep(this, keys_to_extract, keys_to_walk, rebase_dir,
+                         deps_only, own_step.get(), err))
       return false;
+    step = use_steps ? steps->Add(this, std::move(own_step)) : own_step.get();
   }
 
-  // Gather walk keys and find the appropriate target. Targets identified in
-  // the walk key set must be deps or data_deps of the declaring target.
-  const DepsIteratorRange& all_deps = GetDeps(Target::DEPS_ALL);
-  for (const auto& next : next_walk_keys) {
-    DCHECK(next.type() == Value::STRING);
-
-    // If we hit an empty string in this list, add all deps and data_deps. The
-    // ordering in the resulting list of values as a result will be the data
-    // from each explicitly listed dep prior to this, followed by all data in
-    // walk order of the remaining deps.
-    if (next.string_value().empty()) {
-      for (const auto& dep : all_deps) {
-        // If we haven't walked this dep yet, go down into it.
-        auto pair = targets_walked->insert(dep.ptr);
-        if (pair.second) {
-          if (!dep.ptr->GetMetadata(keys_to_extract, keys_to_walk, rebase_dir,
-                                    false, result, targets_walked, err))
-            return false;
-        }
-      }
-
-      // Any other walk keys are superfluous, as they can only be a subset of
-      // all deps.
-      break;
-    }
-
-    // Otherwise, look through the target's deps for the specified one.
-    bool found_next = false;
-    for (const auto& dep : all_deps) {
-      // Match against the label with the toolchain.
-      if (dep.label.GetUserVisibleName(true) == next.string_value()) {
-        // If we haven't walked this dep yet, go down into it.
-        auto pair = targets_walked->insert(dep.ptr);
-        if (pair.second) {
-          if (!dep.ptr->GetMetadata(keys_to_extract, keys_to_walk, rebase_dir,
-                                    false, result, targets_walked, err))
-            return false;
-        }
-        // We found it, so we can exit this search now.
-        found_next = true;
-        break;
-      }
-    }
-    // If we didn't find the specified dep in the target, that's an error.
-    // Propagate it back to the user.
-    if (!found_next) {
-      *err = Err(next.origin(),
-                 std::string("I was expecting ") + next.string_value() +
-                     std::string(" to be a dependency of ") +
-                     label().GetUserVisibleName(true) +
-                     ". Make sure it's included in the deps or data_deps, and "
-                     "that you've specified the appropriate toolchain.");
-      return false;
+  for (const Target* next : step->next) {
+    // If we haven't walked this dep yet, go down into it.
+    auto pair = targets_walked->insert(next);
+    if (pair.second) {
+      if (!next->GetMetadata(keys_to_extract, keys_to_walk, rebase_dir, false,
+                             steps, result, targets_walked, err))
+        return false;
     }
   }
-  result->insert(result->end(), std::make_move_iterator(current_result.begin()),
-                 std::make_move_iterator(current_result.end()));
+  result->insert(result->end(), step->values.begin(), step->values.end());
   return true;
 }
@@ -28,6 +28,7 @@
 #include "tools/gn/unique_vector.h"
 
 class DepsIteratorRange;
+class MetadataWalkSteps;
 class Settings;
 class Toolchain;
 
@@ -163,6 +164,17 @@ class Target : public Item {
                    std::set<const Target*>* targets_walked,
                    Err* err) const;
 
+  // Like GetMetadata(), but reuses the steps of earlier walks with the same
+  // keys from |steps| (when not null), and adds the new ones to it.
+  bool GetMetadata(const std::vector<std::string>& keys_to_extract,
+                   const std::vector<std::string>& keys_to_walk,
+                   const SourceDir& rebase_dir,
+                   bool deps_only,
+                   MetadataWalkSteps* steps,
+                   std::vector<Value>* result,
+                   std::set<const Target*>* targets_walked,
+                   Err* err) const;
+
   // GeneratedFile-related methods.
   bool GenerateFile(Err* err) const;
 
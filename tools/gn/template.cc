@@ -12,6 +12,7 @@
 #include "tools/gn/parse_tree.h"
 #include "tools/gn/scope.h"
 #include "tools/gn/scope_per_file_provider.h"
+#include "tools/gn/source_file.h"
 #include "tools/gn/value.h"
 #include "tools/gn/variables.h"
 
@@ -64,6 +65,11 @@ Value Template::Invoke(Scope* scope,
   Scope template_scope(closure_.get());
   template_scope.set_source_dir(scope->GetSourceDir());
 
+  // Values passed through the invoker can come from any file imported by the
+  // invoking scope, so items defined by the template depend on those too.
+  for (const auto& file : scope->build_dependency_files())
+    template_scope.AddBuildDependencyFile(file);
+
   ScopePerFileProvider per_file_provider(&template_scope, true);
 
   // Targets defined in the template go in the collector for the invoking file.
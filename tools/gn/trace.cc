@@ -5,11 +5,16 @@
 #include "tools/gn/trace.h"
 
 #include <stddef.h>
+#include <stdio.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 #include "base/command_line.h"
@@ -21,12 +26,66 @@
 #include "base/strings/stringprintf.h"
 #include "tools/gn/filesystem_utils.h"
 #include "tools/gn/label.h"
+#include "tools/gn/scheduler.h"
+#include "tools/gn/source_file.h"
+#include "util/build_config.h"
+
+#if defined(OS_LINUX)
+#include <unistd.h>
+#elif defined(OS_MACOSX)
+#include <mach/mach.h>
+#endif
 
 namespace {
 
+// Time between two samples of the trace counters.
+const int kCounterSampleIntervalMs = 10;
+
+std::atomic<int64_t> trace_counters[TRACE_COUNTER_COUNT];
+
+struct CounterSample {
+  Ticks time;
+  int64_t values[TRACE_COUNTER_COUNT];
+  int64_t resident_bytes;  // -1 if not known on this platform.
+};
+
+int64_t GetResidentBytes() {
+#if defined(OS_LINUX)
+  // The second field is the resident set size in pages.
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (!statm)
+    return -1;
+  long size = 0;
+  long resident = 0;
+  int fields = fscanf(statm, "%ld %ld", &size, &resident);
+  fclose(statm);
+  if (fields != 2)
+    return -1;
+  return static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE);
+#elif defined(OS_MACOSX)
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+    return -1;
+  return static_cast<int64_t>(info.resident_size);
+#else
+  return -1;
+#endif
+}
+
+CounterSample TakeCounterSample() {
+  CounterSample sample;
+  sample.time = TicksNow();
+  for (int i = 0; i < TRACE_COUNTER_COUNT; i++)
+    sample.values[i] = trace_counters[i].load(std::memory_order_relaxed);
+  sample.resident_bytes = GetResidentBytes();
+  return sample;
+}
+
 class TraceLog {
  public:
-  TraceLog() { events_.reserve(16384); }
+  TraceLog() : stop_sampling_(false) { events_.reserve(16384); }
   // Trace items leaked intentionally.
 
   void Add(TraceItem* item) {
@@ -34,13 +93,60 @@ class TraceLog {
     events_.push_back(item);
   }
 
+  // Starts the sampling thread if it's not running.
+  void StartSampling() {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (sampler_.joinable())
+      return;
+    stop_sampling_ = false;
+    sampler_ = std::thread(&TraceLog::SampleCounters, this);
+  }
+
+  // Stops the sampling thread after taking one last sample. Does nothing if
+  // it's not running.
+  void StopSampling() {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      if (!sampler_.joinable())
+        return;
+      stop_sampling_ = true;
+    }
+    sampler_cv_.notify_one();
+    sampler_.join();
+
+    CounterSample sample = TakeCounterSample();
+    std::lock_guard<std::mutex> lock(lock_);
+    samples_.push_back(sample);
+  }
+
   // Returns a copy for threadsafety.
   std::vector<TraceItem*> events() const { return events_; }
+  std::vector<CounterSample> samples() const {
+    std::lock_guard<std::mutex> lock(lock_);
+    return samples_;
+  }
 
  private:
-  std::mutex lock_;
+  void SampleCounters() {
+    while (true) {
+      CounterSample sample = TakeCounterSample();
+      std::unique_lock<std::mutex> lock(lock_);
+      samples_.push_back(sample);
+      if (sampler_cv_.wait_for(
+              lock, std::chrono::milliseconds(kCounterSampleIntervalMs),
+              [this]() { return stop_sampling_; }))
+        return;
+    }
+  }
+
+  mutable std::mutex lock_;
 
   std::vector<TraceItem*> events_;
+  std::vector<CounterSample> samples_;
+
+  std::thread sampler_;
+  std::condition_variable sampler_cv_;
+  bool stop_sampling_;
 
   DISALLOW_COPY_AND_ASSIGN(TraceLog);
 };
@@ -108,6 +214,107 @@ void SummarizeScriptExecs(std::vector<const TraceItem*>& execs,
   SummarizeCoalesced(execs, out);
 }
 
+void SummarizeWorkerPool(const WorkerPool::Stats& stats, std::ostream& out) {
+  out << "Worker pool: (threads, spare threads, tasks, stolen, lock "
+         "contentions, idle waits)\n";
+  out << base::StringPrintf(" %8d  %d  ", static_cast<int>(stats.thread_count),
+                            static_cast<int>(stats.spare_thread_count));
+  out << stats.tasks_posted << "  " << stats.tasks_stolen << "  "
+      << stats.lock_contentions << "  " << stats.idle_waits << std::endl;
+}
+
+// Timestamps and durations in the trace log are in microseconds.
+uint64_t TraceTime(Ticks ticks) {
+  return ticks / 1000;
+}
+
+void WriteThreadMetadata(std::thread::id thread_id,
+                         const std::string& name,
+                         int sort_index,
+                         std::ostream& out) {
+  out << "{\"pid\":0,\"tid\":" << thread_id;
+  out << ",\"ts\":0,\"ph\":\"M\",";
+  out << "\"name\":\"thread_name\",\"args\":{\"name\":\"" << name << "\"}},";
+  out << "{\"pid\":0,\"tid\":" << thread_id;
+  out << ",\"ts\":0,\"ph\":\"M\",";
+  out << "\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":"
+      << sort_index << "}},";
+}
+
+void WriteCounter(const char* name,
+                  const char* arg,
+                  Ticks time,
+                  int64_t value,
+                  std::ostream& out) {
+  out << ",{\"pid\":0,\"ts\":" << TraceTime(time);
+  out << ",\"ph\":\"C\",\"name\":\"" << name << "\"";
+  out << ",\"args\":{\"" << arg << "\":" << value << "}}";
+}
+
+// Writes a flow for each defined item that goes from the load of its build
+// file through the execution of that file in the item's toolchain to the
+// ninja write of the item, if it's a target.
+void WriteFlows(const std::vector<TraceItem*>& events, std::ostream& out) {
+  using NameAndToolchain = std::pair<std::string, std::string>;
+  std::map<std::string, const TraceItem*> loads;
+  std::map<NameAndToolchain, const TraceItem*> executes;
+  std::map<NameAndToolchain, const TraceItem*> writes;
+  std::vector<const TraceItem*> defines;
+  for (const TraceItem* item : events) {
+    NameAndToolchain key(item->name(), item->toolchain());
+    if (item->type() == TraceItem::TRACE_FILE_LOAD)
+      loads.emplace(item->name(), item);
+    else if (item->type() == TraceItem::TRACE_FILE_EXECUTE)
+      executes.emplace(key, item);
+    else if (item->type() == TraceItem::TRACE_FILE_WRITE)
+      writes.emplace(key, item);
+    else if (item->type() == TraceItem::TRACE_DEFINE_TARGET)
+      defines.push_back(item);
+  }
+
+  int flow_id = 0;
+  std::string quote_buffer;
+  for (const TraceItem* define : defines) {
+    const std::string& build_file = define->build_file();
+
+    std::vector<const TraceItem*> steps;
+    auto found_load = loads.find(build_file);
+    if (found_load != loads.end())
+      steps.push_back(found_load->second);
+    auto found_execute =
+        executes.find(NameAndToolchain(build_file, define->toolchain()));
+    if (found_execute != executes.end())
+      steps.push_back(found_execute->second);
+    steps.push_back(define);
+    auto found_write =
+        writes.find(NameAndToolchain(define->name(), define->toolchain()));
+    if (found_write != writes.end())
+      steps.push_back(found_write->second);
+    if (steps.size() < 2)
+      continue;
+
+    flow_id++;
+    quote_buffer.resize(0);
+    base::EscapeJSONString(define->name(), true, &quote_buffer);
+    for (size_t i = 0; i < steps.size(); i++) {
+      // "s" starts the flow, "t" is a step, and "f" finishes it.
+      const char* phase = "t";
+      if (i == 0)
+        phase = "s";
+      else if (i == steps.size() - 1)
+        phase = "f";
+
+      out << ",{\"pid\":0,\"tid\":" << steps[i]->thread_id();
+      out << ",\"ts\":" << TraceTime(steps[i]->begin());
+      out << ",\"ph\":\"" << phase << "\",\"id\":" << flow_id;
+      out << ",\"cat\":\"flow\",\"name\":" << quote_buffer;
+      if (i != 0)
+        out << ",\"bp\":\"e\"";  // Bind to the enclosing slice.
+      out << "}";
+    }
+  }
+}
+
 }  // namespace
 
 TraceItem::TraceItem(Type type,
@@ -148,6 +355,11 @@ void ScopedTrace::SetCommandLine(const base::CommandLine& cmdline) {
     item_->set_cmdline(FilePathToUTF8(cmdline.GetArgumentsString()));
 }
 
+void ScopedTrace::SetBuildFile(const SourceFile& build_file) {
+  if (item_)
+    item_->set_build_file(build_file.value());
+}
+
 void ScopedTrace::Done() {
   if (!done_) {
     done_ = true;
@@ -158,11 +370,21 @@ void ScopedTrace::Done() {
   }
 }
 
+void AddToTraceCounter(TraceCounter counter, int64_t delta) {
+  if (trace_log)
+    trace_counters[counter].fetch_add(delta, std::memory_order_relaxed);
+}
+
 void EnableTracing() {
   if (!trace_log)
     trace_log = new TraceLog;
 }
 
+void StartSamplingTraceCounters() {
+  DCHECK(trace_log);
+  trace_log->StartSampling();
+}
+
 bool TracingEnabled() {
   return !!trace_log;
 }
@@ -230,8 +452,12 @@ std::string SummarizeTraces() {
     out << "Header check time: (total time in ms, files checked)\n";
     out << base::StringPrintf(" %8.2f  %d\n", check_headers_time,
                               headers_checked);
+    out << std::endl;
   }
 
+  if (g_scheduler)
+    SummarizeWorkerPool(g_scheduler->GetWorkerPoolStats(), out);
+
   return out.str();
 }
 
@@ -242,20 +468,30 @@ void SaveTraces(const base::FilePath& file_name) {
 
   std::string quote_buffer;  // Allocate outside loop to prevent reallocationg.
 
-  // Write main thread metadata (assume this is being written on the main
-  // thread).
-  out << "{\"pid\":0,\"tid\":" << std::this_thread::get_id();
-  out << ",\"ts\":0,\"ph\":\"M\",";
-  out << "\"name\":\"thread_name\",\"args\":{\"name\":\"Main thread\"}},";
-
+  trace_log->StopSampling();
   std::vector<TraceItem*> events = trace_log->events();
+
+  // Give each thread its own named lane, with the main thread first (assume
+  // this is being written on the main thread).
+  std::thread::id main_thread = std::this_thread::get_id();
+  WriteThreadMetadata(main_thread, "Main thread", 0, out);
+  std::map<std::thread::id, int> worker_threads;
+  for (const TraceItem* item : events) {
+    if (item->thread_id() == main_thread ||
+        worker_threads.find(item->thread_id()) != worker_threads.end())
+      continue;
+    int index = static_cast<int>(worker_threads.size()) + 1;
+    worker_threads[item->thread_id()] = index;
+    WriteThreadMetadata(item->thread_id(),
+                        base::StringPrintf("Worker %d", index), index, out);
+  }
   for (size_t i = 0; i < events.size(); i++) {
     const TraceItem& item = *events[i];
 
     if (i != 0)
       out << ",";
     out << "{\"pid\":0,\"tid\":" << item.thread_id();
-    out << ",\"ts\":" << item.begin();
+    out << ",\"ts\":" << TraceTime(item.begin());
     out << ",\"ph\":\"X\"";  // "X" = complete event with begin & duration.
     out << ",\"dur\":" << item.delta().InMicroseconds();
 
@@ -325,6 +561,21 @@ void SaveTraces(const base::FilePath& file_name) {
     out << "}";
   }
 
+  for (const CounterSample& sample : trace_log->samples()) {
+    WriteCounter("Worker pool tasks", "tasks", sample.time,
+                 sample.values[TRACE_COUNTER_POOL_WORK], out);
+    WriteCounter("Pending records", "records", sample.time,
+                 sample.values[TRACE_COUNTER_PENDING_RECORDS], out);
+    WriteCounter("Bytes written", "bytes", sample.time,
+                 sample.values[TRACE_COUNTER_BYTES_WRITTEN], out);
+    if (sample.resident_bytes >= 0) {
+      WriteCounter("Resident memory", "bytes", sample.time,
+                   sample.resident_bytes, out);
+    }
+  }
+
+  WriteFlows(events, out);
+
   out << "]}";
 
   std::string out_str = out.str();
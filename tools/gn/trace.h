@@ -5,6 +5,8 @@
 #ifndef TOOLS_GN_TRACE_H_
 #define TOOLS_GN_TRACE_H_
 
+#include <stdint.h>
+
 #include <string>
 #include <thread>
 
@@ -12,6 +14,7 @@
 #include "util/ticks.h"
 
 class Label;
+class SourceFile;
 
 namespace base {
 class CommandLine;
@@ -57,6 +60,11 @@ class TraceItem {
   const std::string& cmdline() const { return cmdline_; }
   void set_cmdline(const std::string& c) { cmdline_ = c; }
 
+  // Optional build file that defined the item, used to connect the item to
+  // the load of that file in the trace log.
+  const std::string& build_file() const { return build_file_; }
+  void set_build_file(const std::string& f) { build_file_ = f; }
+
  private:
   Type type_;
   std::string name_;
@@ -67,6 +75,7 @@ class TraceItem {
 
   std::string toolchain_;
   std::string cmdline_;
+  std::string build_file_;
 };
 
 class ScopedTrace {
@@ -77,6 +86,7 @@ class ScopedTrace {
 
   void SetToolchain(const Label& label);
   void SetCommandLine(const base::CommandLine& cmdline);
+  void SetBuildFile(const SourceFile& build_file);
 
   void Done();
 
@@ -85,9 +95,27 @@ class ScopedTrace {
   bool done_;
 };
 
+// Values that are sampled periodically while tracing and saved as counters
+// in the trace log. Resident memory is also sampled but needs no updating.
+enum TraceCounter {
+  TRACE_COUNTER_POOL_WORK,        // Tasks posted to the worker pool not done.
+  TRACE_COUNTER_PENDING_RECORDS,  // BuilderRecords waiting to be resolved.
+  TRACE_COUNTER_BYTES_WRITTEN,    // Bytes written to output files.
+
+  TRACE_COUNTER_COUNT,
+};
+
+// Adds |delta| to the given counter. Does nothing if tracing is off.
+void AddToTraceCounter(TraceCounter counter, int64_t delta);
+
 // Call to turn tracing on. It's off by default.
 void EnableTracing();
 
+// Starts sampling the trace counters on a background thread until the next
+// SaveTraces(). Only useful when the traces are saved, since the summary
+// doesn't include the counters. Tracing must be enabled.
+void StartSamplingTraceCounters();
+
 // Returns whether tracing is enabled.
 bool TracingEnabled();
 
@@ -99,6 +127,11 @@ void AddTrace(TraceItem* item);
 std::string SummarizeTraces();
 
 // Saves the current traces to the given filename in JSON format.
+//
+// Besides the trace events, the file has a named lane for each thread, the
+// sampled counters, and flow events that connect the load of each build file
+// through the execution of the file and the definition of each target to the
+// ninja write of that target.
 void SaveTraces(const base::FilePath& file_name);
 
 #endif  // TOOLS_GN_TRACE_H_
@@ -0,0 +1,73 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tools/gn/trace.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "tools/gn/label.h"
+#include "tools/gn/loader.h"
+#include "tools/gn/source_dir.h"
+#include "tools/gn/source_file.h"
+#include "util/test/test.h"
+
+// Tracing can't be turned off again, so everything is checked in one test. The
+// log is checked as text since base::JSONReader can't read the thread ids.
+TEST(Trace, CounterAndFlowEvents) {
+  EnableTracing();
+  StartSamplingTraceCounters();
+
+  Label toolchain(SourceDir("//toolchain/"), "default");
+  Label label(SourceDir("//trace_test/"), "target");
+  {
+    ScopedTrace trace(TraceItem::TRACE_FILE_LOAD, "//trace_test/BUILD.gn");
+  }
+  {
+    ScopedTrace trace(TraceItem::TRACE_FILE_EXECUTE, "//trace_test/BUILD.gn");
+    trace.SetToolchain(toolchain);
+    ScopedTrace define(TraceItem::TRACE_DEFINE_TARGET, label);
+    define.SetToolchain(toolchain);
+    define.SetBuildFile(Loader::BuildFileForLabel(label));
+  }
+  {
+    ScopedTrace trace(TraceItem::TRACE_FILE_WRITE, label);
+    trace.SetToolchain(toolchain);
+  }
+  AddToTraceCounter(TRACE_COUNTER_BYTES_WRITTEN, 12345);
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath trace_file = temp_dir.GetPath().AppendASCII("trace.json");
+  SaveTraces(trace_file);
+
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(trace_file, &contents));
+
+  // The last sample is taken when the traces are saved, so it includes the
+  // bytes added above.
+  EXPECT_NE(std::string::npos,
+            contents.find("\"ph\":\"C\",\"name\":\"Bytes written\","
+                          "\"args\":{\"bytes\":12345}}"))
+      << contents;
+
+  // One flow goes from the load through the execution of the build file and
+  // the definition of the target to its ninja write. The phase of each flow
+  // event comes before its id and name.
+  const char kFlowName[] = "\"cat\":\"flow\",\"name\":\"//trace_test:target\"";
+  const char kPhase[] = "\"ph\":\"";
+  std::vector<std::string> flow_phases;
+  for (size_t flow = contents.find(kFlowName); flow != std::string::npos;
+       flow = contents.find(kFlowName, flow + 1)) {
+    size_t phase = contents.rfind(kPhase, flow);
+    ASSERT_NE(std::string::npos, phase);
+    flow_phases.push_back(contents.substr(phase + strlen(kPhase), 1));
+  }
+  EXPECT_EQ((std::vector<std::string>{"s", "t", "t", "f"}), flow_phases)
+      << contents;
+}
@@ -26,10 +26,12 @@ Value::Value(const ParseNode* origin, Type t) : type_(t), origin_(origin) {
       int_value_ = 0;
       break;
     case STRING:
-      new (&string_value_) std::string();
+      new (&string_value_)
+          scoped_refptr<StringData>(base::MakeRefCounted<StringData>());
       break;
     case LIST:
-      new (&list_value_) std::vector<Value>();
+      new (&list_value_)
+          scoped_refptr<ListData>(base::MakeRefCounted<ListData>());
       break;
     case SCOPE:
       new (&scope_value_) std::unique_ptr<Scope>();
@@ -50,12 +52,12 @@ Value::Value(const ParseNode* origin, int64_t int_val)
 Value::Value(const ParseNode* origin, std::string str_val)
     : type_(STRING),
       origin_(origin),
-      string_value_(std::move(str_val)) {}
+      string_value_(base::MakeRefCounted<StringData>(std::move(str_val))) {}
 
 Value::Value(const ParseNode* origin, const char* str_val)
     : type_(STRING),
       origin_(origin),
-      string_value_(str_val) {}
+      string_value_(base::MakeRefCounted<StringData>(std::string(str_val))) {}
 
 Value::Value(const ParseNode* origin, std::unique_ptr<Scope> scope)
     : type_(SCOPE),
@@ -73,10 +75,10 @@ Value::Value(const Value& other) : type_(other.type_), origin_(other.origin_) {
       int_value_ = other.int_value_;
       break;
     case STRING:
-      new (&string_value_) std::string(other.string_value_);
+      new (&string_value_) scoped_refptr<StringData>(other.string_value_);
       break;
     case LIST:
-      new (&list_value_) std::vector<Value>(other.list_value_);
+      new (&list_value_) scoped_refptr<ListData>(other.list_value_);
       break;
     case SCOPE:
       new (&scope_value_) std::unique_ptr<Scope>(
@@ -98,15 +100,21 @@ Value::Value(Value&& other) noexcept
       int_value_ = other.int_value_;
       break;
     case STRING:
-      new (&string_value_) std::string(std::move(other.string_value_));
+      new (&string_value_)
+          scoped_refptr<StringData>(std::move(other.string_value_));
       break;
     case LIST:
-      new (&list_value_) std::vector<Value>(std::move(other.list_value_));
+      new (&list_value_) scoped_refptr<ListData>(std::move(other.list_value_));
       break;
     case SCOPE:
       new (&scope_value_) std::unique_ptr<Scope>(std::move(other.scope_value_));
       break;
   }
+
+  // The payload of a moved-from string, list or scope is null, so it can't
+  // keep its type. Other types are reset too so that all moved-from values
+  // look the same.
+  other.type_ = NONE;
 }
 
 Value& Value::operator=(const Value& other) {
@@ -129,10 +137,10 @@ Value::~Value() {
   using namespace std;
   switch (type_) {
     case STRING:
-      string_value_.~string();
+      string_value_.~scoped_refptr<StringData>();
       break;
     case LIST:
-      list_value_.~vector<Value>();
+      list_value_.~scoped_refptr<ListData>();
       break;
     case SCOPE:
       scope_value_.~unique_ptr<Scope>();
@@ -162,6 +170,14 @@ const char* Value::DescribeType(Type t) {
   }
 }
 
+void Value::DetachStringValue() {
+  string_value_ = base::MakeRefCounted<StringData>(string_value_->data);
+}
+
+void Value::DetachListValue() {
+  list_value_ = base::MakeRefCounted<ListData>(list_value_->data);
+}
+
 void Value::SetScopeValue(std::unique_ptr<Scope> scope) {
   DCHECK(type_ == SCOPE);
   scope_value_ = std::move(scope);
@@ -179,7 +195,7 @@ std::string Value::ToString(bool quote_string) const {
       if (quote_string) {
         std::string result = "\"";
         bool hanging_backslash = false;
-        for (char ch : string_value_) {
+        for (char ch : string_value()) {
           // If the last character was a literal backslash and the next
           // character could form a valid escape sequence, we need to insert
           // an extra backslash to prevent that.
@@ -199,13 +215,14 @@ std::string Value::ToString(bool quote_string) const {
         result += '"';
         return result;
       }
-      return string_value_;
+      return string_value();
     case LIST: {
       std::string result = "[";
-      for (size_t i = 0; i < list_value_.size(); i++) {
+      const std::vector<Value>& list = list_value();
+      for (size_t i = 0; i < list.size(); i++) {
         if (i > 0)
           result += ", ";
-        result += list_value_[i].ToString(true);
+        result += list[i].ToString(true);
       }
       result.push_back(']');
       return result;
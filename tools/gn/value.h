@@ -9,15 +9,24 @@
 
 #include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "base/logging.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "tools/gn/err.h"
 
 class ParseNode;
 class Scope;
 
 // Represents a variable value in the interpreter.
+//
+// String and list payloads are reference counted and shared between copies,
+// so copying a value (e.g. through forward_variables_from, template
+// invocations or Scope::MakeClosure) is cheap. The non-const accessors make
+// the payload unique before returning it, so a reference they return must not
+// be held across a copy of the value that is expected to be independent.
 class Value {
  public:
   enum Type {
@@ -43,10 +52,12 @@ class Value {
   Value(const ParseNode* origin, std::unique_ptr<Scope> scope);
 
   Value(const Value& other);
-  Value(Value&& other) noexcept;
   ~Value();
 
   Value& operator=(const Value& other);
+
+  // Moving from a value leaves it as NONE.
+  Value(Value&& other) noexcept;
   Value& operator=(Value&& other) noexcept;
 
   Type type() const { return type_; }
@@ -78,20 +89,24 @@ class Value {
 
   std::string& string_value() {
     DCHECK(type_ == STRING);
-    return string_value_;
+    if (!string_value_->HasOneRef())
+      DetachStringValue();
+    return string_value_->data;
   }
   const std::string& string_value() const {
     DCHECK(type_ == STRING);
-    return string_value_;
+    return string_value_->data;
   }
 
   std::vector<Value>& list_value() {
     DCHECK(type_ == LIST);
-    return list_value_;
+    if (!list_value_->HasOneRef())
+      DetachListValue();
+    return list_value_->data;
   }
   const std::vector<Value>& list_value() const {
     DCHECK(type_ == LIST);
-    return list_value_;
+    return list_value_->data;
   }
 
   Scope* scope_value() {
@@ -120,7 +135,12 @@ class Value {
   bool operator!=(const Value& other) const;
 
  private:
-  void Deallocate();
+  using StringData = base::RefCountedData<std::string>;
+  using ListData = base::RefCountedData<std::vector<Value>>;
+
+  // Replace a shared payload with a private copy of it.
+  void DetachStringValue();
+  void DetachListValue();
 
   Type type_ = NONE;
   const ParseNode* origin_ = nullptr;
@@ -128,8 +148,8 @@ class Value {
   union {
     bool boolean_value_;
     int64_t int_value_;
-    std::string string_value_;
-    std::vector<Value> list_value_;
+    scoped_refptr<StringData> string_value_;
+    scoped_refptr<ListData> list_value_;
     std::unique_ptr<Scope> scope_value_;
   };
 };
@@ -4,6 +4,10 @@
 
 #include <stdint.h>
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "tools/gn/test_with_scope.h"
 #include "tools/gn/value.h"
 #include "util/test/test.h"
@@ -58,3 +62,53 @@ TEST(Value, ToString) {
   Value nested_scopeval(nullptr, std::unique_ptr<Scope>(nested_scope));
   EXPECT_FALSE(nested_scopeval == nested_scopeval);
 }
+
+TEST(Value, CopyOnWrite) {
+  Value list(nullptr, Value::LIST);
+  list.list_value().push_back(Value(nullptr, "a"));
+
+  // Copies share the list until one of them is modified.
+  Value copy(list);
+  const Value& const_list = list;
+  const Value& const_copy = copy;
+  EXPECT_EQ(&const_list.list_value(), &const_copy.list_value());
+
+  copy.list_value().push_back(Value(nullptr, "b"));
+  EXPECT_NE(&const_list.list_value(), &const_copy.list_value());
+  EXPECT_EQ(1u, list.list_value().size());
+  EXPECT_EQ(2u, copy.list_value().size());
+
+  // Modifying a string element of a copy doesn't affect the original.
+  Value nested(list);
+  nested.list_value()[0].string_value() = "c";
+  EXPECT_EQ("a", list.list_value()[0].string_value());
+  EXPECT_EQ("c", nested.list_value()[0].string_value());
+
+  Value str(nullptr, "foo");
+  Value str_copy = str;
+  str_copy.string_value().append("bar");
+  EXPECT_EQ("foo", str.string_value());
+  EXPECT_EQ("foobar", str_copy.string_value());
+}
+
+TEST(Value, Move) {
+  TestWithScope setup;
+  std::vector<Value> values;
+  values.push_back(Value(nullptr, true));
+  values.push_back(Value(nullptr, static_cast<int64_t>(42)));
+  values.push_back(Value(nullptr, "hi"));
+  values.push_back(Value(nullptr, Value::LIST));
+  values.push_back(Value(nullptr, std::make_unique<Scope>(setup.settings())));
+
+  for (Value& value : values) {
+    Value::Type type = value.type();
+    Value moved(std::move(value));
+    EXPECT_EQ(type, moved.type());
+    EXPECT_EQ(Value::NONE, value.type());
+
+    Value assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(type, assigned.type());
+    EXPECT_EQ(Value::NONE, moved.type());
+  }
+}
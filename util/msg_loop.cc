@@ -31,7 +31,7 @@ void MsgLoop::Run() {
       });
 
       if (should_quit_)
-        return;
+        break;
 
       task = std::move(task_queue_.front());
       task_queue_.pop();
@@ -39,6 +39,9 @@ void MsgLoop::Run() {
 
     std::move(task).Run();
   }
+
+  // Allow the loop to be run again.
+  should_quit_ = false;
 }
 
 void MsgLoop::PostQuit() {
@@ -55,6 +58,14 @@ void MsgLoop::PostTask(Task work) {
   notifier_.notify_one();
 }
 
+void MsgLoop::DiscardPendingTasks() {
+  std::queue<Task> discarded;
+  {
+    std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+    discarded.swap(task_queue_);
+  }
+}
+
 void MsgLoop::RunUntilIdleForTesting() {
   for (bool done = false; !done;) {
     Task task;
@@ -28,6 +28,11 @@ class MsgLoop {
   // which Run() was called. Can be called from any thread.
   void PostTask(Task task);
 
+  // Discards all posted work items that haven't run yet. Used to clean up
+  // after a Run() that quit early, e.g. because of an error, before running
+  // the loop again.
+  void DiscardPendingTasks();
+
   // Run()s until the queue is empty. Should only be used (carefully) in tests.
   void RunUntilIdleForTesting();
 
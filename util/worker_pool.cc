@@ -41,57 +41,232 @@ int GetThreadCount() {
   return std::max(num_cores - 1, 8);
 }
 
+// The pool and deque index of the worker running on the current thread, if
+// any. Used to route tasks posted from inside a task to the local deque.
+thread_local WorkerPool* g_current_pool = nullptr;
+thread_local size_t g_current_queue = 0;
+
+// Whether the current thread is inside a ScopedBlockingCall. Only the
+// outermost one counts, so nesting doesn't start more than one spare thread.
+thread_local bool g_in_blocking_call = false;
+
 }  // namespace
 
+WorkerPool::ScopedBlockingCall::ScopedBlockingCall()
+    : pool_(g_in_blocking_call ? nullptr : g_current_pool) {
+  if (pool_) {
+    g_in_blocking_call = true;
+    pool_->BeginBlocking();
+  }
+}
+
+WorkerPool::ScopedBlockingCall::~ScopedBlockingCall() {
+  if (pool_) {
+    pool_->EndBlocking();
+    g_in_blocking_call = false;
+  }
+}
+
 WorkerPool::WorkerPool() : WorkerPool(GetThreadCount()) {}
 
-WorkerPool::WorkerPool(size_t thread_count) : should_stop_processing_(false) {
+WorkerPool::WorkerPool(size_t thread_count)
+    : next_queue_(0),
+      pending_tasks_(0),
+      idle_workers_(0),
+      should_stop_processing_(false),
+      blocked_workers_(0),
+      idle_spares_(0),
+      tasks_posted_(0),
+      tasks_stolen_(0),
+      lock_contentions_(0),
+      idle_waits_(0) {
+  DCHECK_GT(thread_count, 0u);
+  queues_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i)
+    queues_.push_back(std::make_unique<WorkQueue>());
+
   threads_.reserve(thread_count);
   for (size_t i = 0; i < thread_count; ++i)
-    threads_.emplace_back([this]() { Worker(); });
+    threads_.emplace_back([this, i]() { Worker(i); });
 }
 
 WorkerPool::~WorkerPool() {
   {
-    std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+    std::unique_lock<std::mutex> sleep_lock(sleep_mutex_);
     should_stop_processing_ = true;
   }
 
   pool_notifier_.notify_all();
+  spare_notifier_.notify_all();
 
   for (auto& task_thread : threads_) {
     task_thread.join();
   }
+
+  // No spare threads are started once stopping, so the list is final.
+  std::vector<std::thread> spare_threads;
+  {
+    std::unique_lock<std::mutex> sleep_lock(sleep_mutex_);
+    spare_threads.swap(spare_threads_);
+  }
+  for (auto& spare_thread : spare_threads)
+    spare_thread.join();
 }
 
 void WorkerPool::PostTask(Task work) {
+  CHECK(!should_stop_processing_);
+
+  size_t index = g_current_queue;
+  if (g_current_pool != this) {
+    index =
+        next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  }
+
+  // Count the task before it becomes visible so that |pending_tasks_| never
+  // underflows when a worker grabs it right away.
+  pending_tasks_.fetch_add(1);
+  {
+    WorkQueue* queue = queues_[index].get();
+    std::unique_lock<std::mutex> queue_lock = LockQueue(queue);
+    queue->tasks.push_back(std::move(work));
+    queue->size.fetch_add(1, std::memory_order_relaxed);
+  }
+  tasks_posted_.fetch_add(1, std::memory_order_relaxed);
+
+  // A worker registers itself as idle before checking |pending_tasks_| under
+  // |sleep_mutex_|, so either it sees the new task or we see it idle here.
+  if (idle_workers_.load() > 0) {
+    std::unique_lock<std::mutex> sleep_lock(sleep_mutex_);
+    pool_notifier_.notify_one();
+  }
+  if (idle_spares_.load() > 0 && blocked_workers_.load() > 0) {
+    std::unique_lock<std::mutex> sleep_lock(sleep_mutex_);
+    spare_notifier_.notify_all();
+  }
+}
+
+WorkerPool::Stats WorkerPool::GetStats() const {
+  Stats stats;
+  stats.thread_count = threads_.size();
   {
-    std::unique_lock<std::mutex> queue_lock(queue_mutex_);
-    CHECK(!should_stop_processing_);
-    task_queue_.emplace(std::move(work));
+    std::unique_lock<std::mutex> sleep_lock(sleep_mutex_);
+    stats.spare_thread_count = spare_threads_.size();
   }
+  stats.tasks_posted = tasks_posted_.load(std::memory_order_relaxed);
+  stats.tasks_stolen = tasks_stolen_.load(std::memory_order_relaxed);
+  stats.lock_contentions = lock_contentions_.load(std::memory_order_relaxed);
+  stats.idle_waits = idle_waits_.load(std::memory_order_relaxed);
+  return stats;
+}
 
-  pool_notifier_.notify_one();
+std::unique_lock<std::mutex> WorkerPool::LockQueue(WorkQueue* queue) {
+  std::unique_lock<std::mutex> lock(queue->mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    lock_contentions_.fetch_add(1, std::memory_order_relaxed);
+    lock.lock();
+  }
+  return lock;
 }
 
-void WorkerPool::Worker() {
+bool WorkerPool::TakeTask(size_t index, Task* task) {
+  // Newest task from our own deque first.
+  WorkQueue* own = queues_[index].get();
+  if (own->size.load(std::memory_order_relaxed) > 0) {
+    std::unique_lock<std::mutex> queue_lock = LockQueue(own);
+    if (!own->tasks.empty()) {
+      *task = std::move(own->tasks.back());
+      own->tasks.pop_back();
+      own->size.fetch_sub(1, std::memory_order_relaxed);
+      pending_tasks_.fetch_sub(1);
+      return true;
+    }
+  }
+
+  // Then the oldest task of any other worker.
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    WorkQueue* victim = queues_[(index + i) % queues_.size()].get();
+    if (victim->size.load(std::memory_order_relaxed) == 0)
+      continue;
+    std::unique_lock<std::mutex> queue_lock = LockQueue(victim);
+    if (!victim->tasks.empty()) {
+      *task = std::move(victim->tasks.front());
+      victim->tasks.pop_front();
+      victim->size.fetch_sub(1, std::memory_order_relaxed);
+      pending_tasks_.fetch_sub(1);
+      tasks_stolen_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkerPool::Worker(size_t index) {
+  g_current_pool = this;
+  g_current_queue = index;
+
   for (;;) {
     Task task;
+    if (TakeTask(index, &task)) {
+      std::move(task).Run();
+      continue;
+    }
 
-    {
-      std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+    std::unique_lock<std::mutex> sleep_lock(sleep_mutex_);
+    idle_workers_.fetch_add(1);
+    if (pending_tasks_.load() == 0 && !should_stop_processing_)
+      idle_waits_.fetch_add(1, std::memory_order_relaxed);
+    pool_notifier_.wait(sleep_lock, [this]() {
+      return pending_tasks_.load() > 0 || should_stop_processing_;
+    });
+    idle_workers_.fetch_sub(1);
 
-      pool_notifier_.wait(queue_lock, [this]() {
-        return (!task_queue_.empty()) || should_stop_processing_;
-      });
+    if (should_stop_processing_ && pending_tasks_.load() == 0)
+      return;
+  }
+}
 
-      if (should_stop_processing_ && task_queue_.empty())
-        return;
+void WorkerPool::SpareWorker(size_t ordinal) {
+  g_current_pool = this;
+  g_current_queue = ordinal % queues_.size();
 
-      task = std::move(task_queue_.front());
-      task_queue_.pop();
+  for (;;) {
+    Task task;
+    if (blocked_workers_.load() > ordinal &&
+        TakeTask(g_current_queue, &task)) {
+      std::move(task).Run();
+      continue;
     }
 
-    std::move(task).Run();
+    std::unique_lock<std::mutex> sleep_lock(sleep_mutex_);
+    idle_spares_.fetch_add(1);
+    spare_notifier_.wait(sleep_lock, [this, ordinal]() {
+      return (blocked_workers_.load() > ordinal &&
+              pending_tasks_.load() > 0) ||
+             should_stop_processing_;
+    });
+    idle_spares_.fetch_sub(1);
+
+    // The regular workers run whatever is left.
+    if (should_stop_processing_)
+      return;
   }
 }
+
+void WorkerPool::BeginBlocking() {
+  std::unique_lock<std::mutex> sleep_lock(sleep_mutex_);
+  size_t blocked = blocked_workers_.fetch_add(1) + 1;
+  if (should_stop_processing_)
+    return;
+  if (spare_threads_.size() < blocked) {
+    size_t ordinal = spare_threads_.size();
+    spare_threads_.emplace_back([this, ordinal]() { SpareWorker(ordinal); });
+  } else if (idle_spares_.load() > 0) {
+    spare_notifier_.notify_all();
+  }
+}
+
+void WorkerPool::EndBlocking() {
+  // A spare thread that is no longer needed finishes its current task and
+  // goes back to sleep.
+  blocked_workers_.fetch_sub(1);
+}
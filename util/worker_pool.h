@@ -5,31 +5,137 @@
 #ifndef UTIL_WORKER_POOL_H_
 #define UTIL_WORKER_POOL_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <vector>
 
 #include "base/logging.h"
 #include "base/macros.h"
 #include "util/task.h"
 
+// A pool of worker threads with one task deque per thread.
+//
+// Tasks posted from a worker thread go to the back of that worker's own deque
+// and are popped from the back again (LIFO), which keeps related work on the
+// same thread. Tasks posted from any other thread are distributed round-robin
+// over the deques. A worker whose deque is empty steals from the front of the
+// other workers' deques before going to sleep.
+//
+// A task that waits for something other than the CPU for a long time (such as
+// a child process) can wrap the wait in a ScopedBlockingCall. While it waits,
+// a spare thread runs tasks in its place so the pool keeps all cores busy.
 class WorkerPool {
  public:
+  // Marks the current worker as blocked for the lifetime of this object. Does
+  // nothing when not called from a worker thread or when nested in another
+  // ScopedBlockingCall.
+  class ScopedBlockingCall {
+   public:
+    ScopedBlockingCall();
+    ~ScopedBlockingCall();
+
+   private:
+    WorkerPool* pool_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedBlockingCall);
+  };
+
+  // Counters describing how the pool was used. Collected with relaxed atomics
+  // so the values are only approximate while tasks are still running.
+  struct Stats {
+    size_t thread_count = 0;
+
+    // Number of threads started to stand in for blocked workers.
+    size_t spare_thread_count = 0;
+
+    // Number of tasks posted to the pool.
+    uint64_t tasks_posted = 0;
+
+    // Number of tasks a worker took from another worker's deque.
+    uint64_t tasks_stolen = 0;
+
+    // Number of times a deque lock could not be acquired without blocking.
+    uint64_t lock_contentions = 0;
+
+    // Number of times a worker went to sleep waiting for work.
+    uint64_t idle_waits = 0;
+  };
+
   WorkerPool();
   WorkerPool(size_t thread_count);
   ~WorkerPool();
 
   void PostTask(Task work);
 
+  Stats GetStats() const;
+
  private:
-  void Worker();
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+
+    // Mirrors tasks.size() so that thieves can skip empty deques without
+    // taking the lock.
+    std::atomic<size_t> size{0};
+  };
+
+  void Worker(size_t index);
+
+  // Runs tasks while more than |ordinal| workers are blocked.
+  void SpareWorker(size_t ordinal);
+
+  // Called by ScopedBlockingCall.
+  void BeginBlocking();
+  void EndBlocking();
+
+  // Locks |queue|, recording a contention if the lock was already held.
+  std::unique_lock<std::mutex> LockQueue(WorkQueue* queue);
+
+  // Pops a task from the back of the given worker's own deque, or steals one
+  // from the front of another worker's deque. Returns false if every deque
+  // was empty.
+  bool TakeTask(size_t index, Task* task);
 
   std::vector<std::thread> threads_;
-  std::queue<base::OnceClosure> task_queue_;
-  std::mutex queue_mutex_;
-  std::condition_variable_any pool_notifier_;
-  bool should_stop_processing_;
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+
+  // Index of the next deque used for tasks posted from outside the pool.
+  std::atomic<size_t> next_queue_;
+
+  // Number of tasks sitting in any of the deques.
+  std::atomic<size_t> pending_tasks_;
+
+  // Number of workers blocked (or about to block) on |pool_notifier_|.
+  std::atomic<size_t> idle_workers_;
+
+  // Protects sleeping and waking up workers. |should_stop_processing_| is only
+  // written with this lock held.
+  mutable std::mutex sleep_mutex_;
+  std::condition_variable pool_notifier_;
+  std::atomic<bool> should_stop_processing_;
+
+  // Number of workers inside a ScopedBlockingCall.
+  std::atomic<size_t> blocked_workers_;
+
+  // Started on demand, one for each worker blocked at the same time, and kept
+  // until the pool is destroyed. Only modified with |sleep_mutex_| held.
+  std::vector<std::thread> spare_threads_;
+
+  // Number of spare threads blocked (or about to block) on |spare_notifier_|.
+  std::atomic<size_t> idle_spares_;
+  std::condition_variable spare_notifier_;
+
+  std::atomic<uint64_t> tasks_posted_;
+  std::atomic<uint64_t> tasks_stolen_;
+  std::atomic<uint64_t> lock_contentions_;
+  std::atomic<uint64_t> idle_waits_;
 
   DISALLOW_COPY_AND_ASSIGN(WorkerPool);
 };
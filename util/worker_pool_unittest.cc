@@ -0,0 +1,199 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/worker_pool.h"
+
+#include <stdint.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "base/bind.h"
+#include "base/macros.h"
+#include "util/test/test.h"
+
+namespace {
+
+// A counter that can be waited on. Waits time out so that a broken pool fails
+// the test instead of hanging it.
+class Counter {
+ public:
+  Counter() : value_(0) {}
+
+  void Increment() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    value_++;
+    changed_.notify_all();
+  }
+
+  int value() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return value_;
+  }
+
+  // Returns false if the counter didn't reach |value| in time.
+  bool WaitFor(int value) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, std::chrono::seconds(10),
+                             [this, value]() { return value_ >= value; });
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable changed_;
+  int value_;
+
+  DISALLOW_COPY_AND_ASSIGN(Counter);
+};
+
+const int kThreadCount = 4;
+
+void Increment(Counter* counter) {
+  counter->Increment();
+}
+
+// Counts itself and posts |count| more tasks that do the same with one less.
+void PostTree(WorkerPool* pool, Counter* counter, int count) {
+  counter->Increment();
+  for (int i = 0; i < count; i++)
+    pool->PostTask(base::BindOnce(&PostTree, pool, counter, count - 1));
+}
+
+// Waits until |kThreadCount| tasks run at the same time.
+void WaitForAllWorkers(Counter* arrived, Counter* failed) {
+  arrived->Increment();
+  if (!arrived->WaitFor(kThreadCount))
+    failed->Increment();
+}
+
+// Posts one task per worker to the deque of the current worker. They can only
+// run at the same time if the other workers steal them.
+void PostToAllWorkers(WorkerPool* pool, Counter* arrived, Counter* failed) {
+  for (int i = 0; i < kThreadCount; i++)
+    pool->PostTask(base::BindOnce(&WaitForAllWorkers, arrived, failed));
+}
+
+// Posts a task that sets |done| and waits for it in a blocking call. Counts
+// |unblocked| if it was set.
+void PostAndBlock(WorkerPool* pool, Counter* done, Counter* unblocked) {
+  WorkerPool::ScopedBlockingCall blocking;
+  pool->PostTask(base::BindOnce(&Increment, done));
+  if (done->WaitFor(1))
+    unblocked->Increment();
+}
+
+// Like PostAndBlock(), but inside a second, nested blocking call.
+void PostAndBlockNested(WorkerPool* pool, Counter* done, Counter* unblocked) {
+  WorkerPool::ScopedBlockingCall blocking;
+  PostAndBlock(pool, done, unblocked);
+}
+
+// Blocks until |arrived| reaches |count| and then until |release| is set.
+// Counts |finished| when done.
+void BlockTogether(Counter* arrived,
+                   int count,
+                   Counter* release,
+                   Counter* finished) {
+  {
+    WorkerPool::ScopedBlockingCall blocking;
+    arrived->Increment();
+    if (arrived->WaitFor(count))
+      release->WaitFor(1);
+  }
+  finished->Increment();
+}
+
+void SleepAndIncrement(Counter* counter) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  counter->Increment();
+}
+
+}  // namespace
+
+TEST(WorkerPool, RunsAllTasks) {
+  WorkerPool pool(kThreadCount);
+  Counter counter;
+
+  // 1 + 5 + 5*4 + 5*4*3 + 5*4*3*2 + 5*4*3*2*1 tasks, most of them posted from
+  // worker threads.
+  pool.PostTask(base::BindOnce(&PostTree, &pool, &counter, 5));
+  for (int i = 0; i < 10; i++)
+    pool.PostTask(base::BindOnce(&Increment, &counter));
+  EXPECT_TRUE(counter.WaitFor(326 + 10));
+
+  EXPECT_EQ(326u + 10u, pool.GetStats().tasks_posted);
+}
+
+TEST(WorkerPool, StealsTasks) {
+  WorkerPool pool(kThreadCount);
+  Counter arrived;
+  Counter failed;
+
+  pool.PostTask(base::BindOnce(&PostToAllWorkers, &pool, &arrived, &failed));
+  EXPECT_TRUE(arrived.WaitFor(kThreadCount));
+  EXPECT_EQ(0, failed.value());
+
+  // The posting worker ran one of its tasks itself.
+  EXPECT_LE(static_cast<uint64_t>(kThreadCount - 1),
+            pool.GetStats().tasks_stolen);
+}
+
+TEST(WorkerPool, BlockingCallDoesNotStarveQueuedWork) {
+  // With one worker, the posted task can only run on a spare thread while the
+  // task that posted it waits for it.
+  WorkerPool pool(1);
+  Counter done;
+  Counter unblocked;
+
+  pool.PostTask(base::BindOnce(&PostAndBlock, &pool, &done, &unblocked));
+  EXPECT_TRUE(unblocked.WaitFor(1));
+  EXPECT_EQ(1u, pool.GetStats().spare_thread_count);
+}
+
+TEST(WorkerPool, NestedBlockingCalls) {
+  // The worker is only blocked once, so one spare thread runs the task.
+  WorkerPool pool(1);
+  Counter done;
+  Counter unblocked;
+
+  pool.PostTask(base::BindOnce(&PostAndBlockNested, &pool, &done, &unblocked));
+  EXPECT_TRUE(unblocked.WaitFor(1));
+  EXPECT_EQ(1u, pool.GetStats().spare_thread_count);
+}
+
+TEST(WorkerPool, SpareThreadLimit) {
+  // There are never more spare threads than threads blocked at the same time,
+  // and they are reused for later blocking calls.
+  const int kBlockingTasks = 3;
+  WorkerPool pool(2);
+  for (int round = 0; round < 2; round++) {
+    Counter arrived;
+    Counter release;
+    Counter finished;
+    for (int i = 0; i < kBlockingTasks; i++) {
+      pool.PostTask(base::BindOnce(&BlockTogether, &arrived, kBlockingTasks,
+                                   &release, &finished));
+    }
+    EXPECT_TRUE(arrived.WaitFor(kBlockingTasks));
+    EXPECT_EQ(static_cast<size_t>(kBlockingTasks),
+              pool.GetStats().spare_thread_count);
+
+    release.Increment();
+    EXPECT_TRUE(finished.WaitFor(kBlockingTasks));
+  }
+  EXPECT_EQ(static_cast<size_t>(kBlockingTasks),
+            pool.GetStats().spare_thread_count);
+}
+
+TEST(WorkerPool, DestructorRunsPendingTasks) {
+  Counter counter;
+  {
+    WorkerPool pool(2);
+    for (int i = 0; i < 100; i++)
+      pool.PostTask(base::BindOnce(&SleepAndIncrement, &counter));
+  }
+  EXPECT_EQ(100, counter.value());
+}